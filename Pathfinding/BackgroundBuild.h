@@ -0,0 +1,52 @@
+//level data built again on a thread of its own after the level changed, so an edit doesnt stall the frame with a rebuild
+//of the whole level
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "PathfindingGrid.h"
+
+//the build works on a copy of the grid taken when it starts, so the level can go on changing under it, the owner polls
+//Done and takes what was built once it is, and starts it again if the level changed in a way the copy doesnt cover
+//whatever fnBuild writes to belongs to the build thread until Join, the owner has to be declared before the build so the
+//build is joined before it is destroyed
+class BackgroundBuild
+{
+	std::thread thread;
+	std::atomic<bool> bDone{ false };
+	//started and not finished yet
+	bool bActive = false;
+	PathfindingGrid Snapshot;
+
+public:
+	~BackgroundBuild() { Join(); }
+
+	bool Running() const { return bActive; }
+	bool Done() const { return bActive && bDone.load(std::memory_order_acquire); }
+	void Start(const PathfindingGrid& grid, std::function<void(const PathfindingGrid&)> fnBuild)
+	{
+		Finish();
+		Snapshot = grid;
+		bDone.store(false, std::memory_order_relaxed);
+		bActive = true;
+		thread = std::thread([this, fnBuild]()
+			{
+				fnBuild(Snapshot);
+				bDone.store(true, std::memory_order_release);
+			});
+	}
+
+	//blocks until the build is done, it is still Running until Finish
+	void Join()
+	{
+		if (thread.joinable())
+			thread.join();
+	}
+
+	//the owner took what was built or drops it
+	void Finish()
+	{
+		Join();
+		bActive = false;
+	}
+};
@@ -0,0 +1,207 @@
+//bidirectional A*, one frontier from the start towards the target and one from the target towards the start
+//both order their openlists by G plus the same balanced estimate, half of what the heuristic says is left towards
+//their goal minus half of what it says is behind them, for the frontier from the target it is the same with the sign
+//turned around, so a path through any cell has the same F + F on both sides as its cost
+//every cell either frontier opens is checked against the other, the cheapest sum of both G is where they meet, and
+//once the least F of both openlists add up to that cost no path left can be cheaper and the search stops
+//the grid is undirected so the frontier from the target runs the same SearchKernel expansion backwards
+template <class Connectivity, class Corners, class Heuristic, class Cost, class OpenListType>
+struct BidirectionalKernel
+{
+	typedef SearchKernel<Connectivity, Corners, Heuristic, Cost, OpenListType> Kernel;
+	typedef typename Cost::Type CostType;
+	//expansions of each frontier between two meetings of the threads with bParallelFrontiers, short searches start
+	//with small rounds so they dont run far past the meeting, the rounds grow with the search up to the most a
+	//meeting of the threads is worth
+	static constexpr int iFirstRound = 16, iLastRound = 256;
+
+	//one round of the frontier from the target on the helper thread
+	struct Round
+	{
+		const PathfindingGrid* pGrid;
+		SearchContext* pContext;
+		glm::ivec2 ivTowards, ivAwayFrom;
+		int iExpansions;
+	};
+
+	//the balanced estimate, with integer costs the octile and manhattan estimates are even so the half is exact,
+	//the euclidean one can be a unit off
+	static CostType Estimate(const SearchContext& side, int iX, int iY, const glm::ivec2& ivTowards, const glm::ivec2& ivAwayFrom)
+	{
+		return (Kernel::H(side, iX, iY, ivTowards) - Kernel::H(side, iX, iY, ivAwayFrom)) / CostType(2);
+	}
+
+	//resets one frontier and puts the cell it starts from on its openlist
+	static void BeginSide(const PathfindingGrid& grid, SearchContext& side, const glm::ivec2& ivFrom, const glm::ivec2& ivTowards)
+	{
+		OpenListType& openList = side.template OpenListOf<OpenListType>();
+		int iCell = grid.Index(ivFrom);
+		side.SearchSpace.Reset();
+		openList.Clear();
+		side.SearchSpace.Open(iCell, CostType(0), -1);
+		openList.Push(iCell, Estimate(side, ivFrom.x, ivFrom.y, ivTowards, ivFrom), CostType(0));
+		SEARCH_STAT(side.Stats.iGenerated = side.Stats.iPeakOpen = side.Stats.iHeuristicCalls = 1);
+	}
+
+	static void Begin(const PathfindingGrid& grid, SearchContext& context, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos)
+	{
+		SearchContext& backward = context.BackwardContext();
+		backward.SearchSpace.bRecordVisited = context.SearchSpace.bRecordVisited;
+		backward.pLandmarks = context.pLandmarks;
+		backward.Stats = SearchStats();
+		backward.iExpansions = 0;
+		BeginSide(grid, context, ivStartPos, ivTargetPos);
+		BeginSide(grid, backward, ivTargetPos, ivStartPos);
+		context.iMeetingCell = -1;
+		//the frontiers only meet in cells opened after this
+		if (ivStartPos == ivTargetPos)
+		{
+			context.iMeetingCell = grid.Index(ivStartPos);
+			context.fMeetingCost = 0.0;
+		}
+	}
+
+	static SearchStatus Continue(const PathfindingGrid& grid, SearchContext& context, PathResult& result, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos, int iMaxExpansions)
+	{
+		SearchContext& backward = context.BackwardContext();
+		OpenListType& forwardList = context.template OpenListOf<OpenListType>();
+		OpenListType& backwardList = backward.template OpenListOf<OpenListType>();
+
+		int iExpansions = 0;
+		while (!Done(context, backward))
+		{
+			if (iMaxExpansions >= 0 && iExpansions >= iMaxExpansions)
+				return SEARCH_RUNNING;
+
+			if (context.bParallelFrontiers)
+			{
+				int iRound = glm::clamp(static_cast<int>(context.iExpansions / 2), iFirstRound, iLastRound);
+				if (iMaxExpansions >= 0)
+					iRound = glm::min(iRound, (iMaxExpansions - iExpansions + 1) / 2);
+				iExpansions += ParallelRound(grid, context, backward, ivStartPos, ivTargetPos, iRound);
+				continue;
+			}
+
+			//the frontier with the smaller openlist goes next, that keeps both about the same size
+			bool bForward = forwardList.Size() <= backwardList.Size();
+			SearchContext& side = bForward ? context : backward;
+			SearchContext& other = bForward ? backward : context;
+			OpenListType& openList = bForward ? forwardList : backwardList;
+			int iCurrentCell = openList.Pop().iCell;
+			context.iExpansions++;
+			iExpansions++;
+			const glm::ivec2& ivTowards = bForward ? ivTargetPos : ivStartPos;
+			const glm::ivec2& ivAwayFrom = bForward ? ivStartPos : ivTargetPos;
+			Kernel::Expand(grid, side, openList, iCurrentCell, [&](int iX, int iY) { return Estimate(side, iX, iY, ivTowards, ivAwayFrom); }, [&](int iCell)
+				{
+					Meet(context, side, other, iCell);
+				});
+		}
+		return Finish(grid, context, backward, result, grid.Index(ivStartPos));
+	}
+
+	//every path the frontiers havent met on yet leaves the forward openlist at a cell and enters the backward one
+	//at a cell, with the balanced estimates it costs at least the sum of their F, so once the least F add up to the
+	//meeting found no path left can beat it, or one frontier ran out of cells and there is no path
+	static bool Done(SearchContext& context, SearchContext& backward)
+	{
+		OpenListType& forwardList = context.template OpenListOf<OpenListType>();
+		OpenListType& backwardList = backward.template OpenListOf<OpenListType>();
+		if (forwardList.Empty() || backwardList.Empty())
+			return true;
+		if (context.iMeetingCell == -1)
+			return false;
+		return context.fMeetingCost <= static_cast<double>(forwardList.Top().F) + static_cast<double>(backwardList.Top().F);
+	}
+
+	//side just set the G of iCell, if the other frontier got there too the path through it is a candidate
+	static void Meet(SearchContext& context, SearchContext& side, SearchContext& other, int iCell)
+	{
+		if (other.SearchSpace.State(iCell) == NODE_NONE)
+			return;
+		double fCost = static_cast<double>(side.SearchSpace.template Costs<CostType>()[iCell]) + static_cast<double>(other.SearchSpace.template Costs<CostType>()[iCell]);
+		if (context.iMeetingCell == -1 || fCost < context.fMeetingCost)
+		{
+			context.iMeetingCell = iCell;
+			context.fMeetingCost = fCost;
+		}
+	}
+
+	static int ExpandRound(const PathfindingGrid& grid, SearchContext& side, const glm::ivec2& ivTowards, const glm::ivec2& ivAwayFrom, int iRound)
+	{
+		OpenListType& openList = side.template OpenListOf<OpenListType>();
+		int iExpansions = 0;
+		for (; iExpansions < iRound && !openList.Empty(); iExpansions++)
+			Kernel::Expand(grid, side, openList, openList.Pop().iCell, [&](int iX, int iY) { return Estimate(side, iX, iY, ivTowards, ivAwayFrom); },
+				[&side](int iCell) { side.vecOpened.push_back(iCell); });
+		return iExpansions;
+	}
+
+	static void ExpandBackwardRound(void* pRound)
+	{
+		Round& round = *static_cast<Round*>(pRound);
+		round.iExpansions = ExpandRound(*round.pGrid, *round.pContext, round.ivTowards, round.ivAwayFrom, round.iExpansions);
+	}
+
+	//both frontiers expand up to iRound nodes at the same time, each only writes to its own context
+	//the cells they opened are checked against the other frontier once both are done and neither writes anymore
+	static int ParallelRound(const PathfindingGrid& grid, SearchContext& context, SearchContext& backward, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos, int iRound)
+	{
+		context.vecOpened.clear();
+		backward.vecOpened.clear();
+		Round round{ &grid, &backward, ivStartPos, ivTargetPos, iRound };
+		context.HelperThread().Run(&ExpandBackwardRound, &round);
+		int iExpansions = ExpandRound(grid, context, ivTargetPos, ivStartPos, iRound);
+		context.HelperThread().Wait();
+		iExpansions += round.iExpansions;
+		context.iExpansions += iExpansions;
+
+		for (int iCell : context.vecOpened)
+			Meet(context, context, backward, iCell);
+		for (int iCell : backward.vecOpened)
+			Meet(context, backward, context, iCell);
+		return iExpansions;
+	}
+
+	//the records of both frontiers go into the one of the search, the peak openlist is the sum of both peaks
+	static void MergeStats(SearchContext& context, SearchContext& backward)
+	{
+		SEARCH_STAT(context.Stats.iGenerated += backward.Stats.iGenerated);
+		SEARCH_STAT(context.Stats.iReopened += backward.Stats.iReopened);
+		SEARCH_STAT(context.Stats.iPeakOpen += backward.Stats.iPeakOpen);
+		SEARCH_STAT(context.Stats.iPeakClosed += backward.Stats.iPeakClosed);
+		SEARCH_STAT(context.Stats.iHeuristicCalls += backward.Stats.iHeuristicCalls);
+		(void)context;
+		(void)backward;
+	}
+
+	//the path in the same form SearchKernel::ConstructPath gives, target first without the start
+	//the half from the target to the meeting cell is walked along the parents of the backward frontier, which lead to
+	//the target, and turned around, the half from the meeting cell to the start follows the forward parents
+	static SearchStatus Finish(const PathfindingGrid& grid, SearchContext& context, SearchContext& backward, PathResult& result, int iStartCell)
+	{
+		MergeStats(context, backward);
+		int iMeetingCell = context.iMeetingCell;
+		if (iMeetingCell == -1)
+			return SEARCH_FAILED;
+
+		std::vector<CostType>& vecForwardG = context.SearchSpace.template Costs<CostType>();
+		std::vector<CostType>& vecBackwardG = backward.SearchSpace.template Costs<CostType>();
+		CostType Total = vecForwardG[iMeetingCell] + vecBackwardG[iMeetingCell];
+		result.fCost = Cost::ToFloat(Total);
+
+		std::size_t iBackwardBegin = result.vecPath.size();
+		for (int iCell = backward.SearchSpace.vecParent[iMeetingCell]; iCell != -1; iCell = backward.SearchSpace.vecParent[iCell])
+			result.vecPath.push_back(PathfindingNode(grid.Position(iCell), Cost::ToFloat(Total - vecBackwardG[iCell])));
+		std::reverse(result.vecPath.begin() + iBackwardBegin, result.vecPath.end());
+		for (int iCell = iMeetingCell; iCell != iStartCell; iCell = context.SearchSpace.vecParent[iCell])
+			result.vecPath.push_back(PathfindingNode(grid.Position(iCell), Cost::ToFloat(vecForwardG[iCell])));
+
+		if (context.SearchSpace.bRecordVisited)
+		{
+			std::swap(result.vecVisitedCells, context.SearchSpace.vecVisited);
+			result.vecVisitedCells.insert(result.vecVisitedCells.end(), backward.SearchSpace.vecVisited.begin(), backward.SearchSpace.vecVisited.end());
+		}
+		return SEARCH_FOUND;
+	}
+};
@@ -0,0 +1,256 @@
+//connected components of the walkable cells of a PathfindingGrid
+//two cells with different labels can never be connected so a search between them is rejected without expanding a node
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+
+//8 connected the same way the a* Neighbors are, diagonal steps past corners included
+//the labels are kept flat, one per cell, so a query is two reads and never writes, which keeps it safe on the worker threads
+class ConnectedRegions
+{
+	//label of every cell, 0 for obstacles
+	std::vector<std::uint32_t> vecLabels;
+	//number of cells with every label, labels of merged or split regions are left empty and never reused
+	std::vector<std::uint32_t> vecSizes;
+	std::vector<int> vecStack;
+	//scratch of RemoveCell, the cells of the flood from every neighbor still to expand and every cell relabeled
+	std::vector<int> vecFloods[GridDirection::iCount];
+	std::vector<int> vecVisited;
+
+	std::uint32_t NewLabel()
+	{
+		vecSizes.push_back(0);
+		return static_cast<std::uint32_t>(vecSizes.size() - 1);
+	}
+
+	void Relabel(int iCell, std::uint32_t iLabel)
+	{
+		vecSizes[vecLabels[iCell]]--;
+		vecLabels[iCell] = iLabel;
+		vecSizes[iLabel]++;
+	}
+
+	//gives every walkable cell reachable from iCell the label of iCell
+	void Flood(const PathfindingGrid& grid, int iCell)
+	{
+		std::uint32_t iLabel = vecLabels[iCell];
+		vecStack.clear();
+		vecStack.push_back(iCell);
+		while (!vecStack.empty())
+		{
+			glm::ivec2 ivPos = grid.Position(vecStack.back());
+			vecStack.pop_back();
+			for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+			{
+				int iX = ivPos.x + GridDirection::iX[iDir], iY = ivPos.y + GridDirection::iY[iDir];
+				if (!grid.IsWalkable(iX, iY))
+					continue;
+				int iNeighborCell = grid.Index(iX, iY);
+				if (vecLabels[iNeighborCell] == iLabel)
+					continue;
+				Relabel(iNeighborCell, iLabel);
+				vecStack.push_back(iNeighborCell);
+			}
+		}
+	}
+
+	//whether the walkable neighbors of the cell reach each other around it without stepping on it, then taking the
+	//cell out cant split its region, which is the usual case on open floor and along a wall
+	//the neighbors in order around the cell, each one touches the next and every straight one also the straight one
+	//after it across the corner between them
+	static bool NeighborsConnected(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		static const int iRingX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static const int iRingY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+		bool bWalkable[8];
+		int iParts[8];
+		for (int i = 0; i < 8; i++)
+		{
+			bWalkable[i] = grid.IsWalkable(ivGridPos.x + iRingX[i], ivGridPos.y + iRingY[i]);
+			iParts[i] = i;
+		}
+		auto Find = [&](int i) { while (iParts[i] != i) i = iParts[i]; return i; };
+		auto Join = [&](int a, int b)
+		{
+			if (bWalkable[a] && bWalkable[b])
+				iParts[Find(a)] = Find(b);
+		};
+		for (int i = 0; i < 8; i++)
+		{
+			Join(i, (i + 1) % 8);
+			if (i % 2 == 0)
+				Join(i, (i + 2) % 8);
+		}
+		int iPart = -1;
+		for (int i = 0; i < 8; i++)
+		{
+			if (!bWalkable[i])
+				continue;
+			if (iPart == -1)
+				iPart = Find(i);
+			else if (Find(i) != iPart)
+				return false;
+		}
+		return true;
+	}
+
+public:
+	bool Empty() const { return vecLabels.empty(); }
+
+	void Clear()
+	{
+		vecLabels.clear();
+		vecLabels.shrink_to_fit();
+		vecSizes.clear();
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return (vecLabels.capacity() + vecSizes.capacity()) * sizeof(std::uint32_t);
+	}
+
+	//number of regions with at least one cell
+	int Count() const
+	{
+		int iCount = 0;
+		for (std::size_t i = 1; i < vecSizes.size(); i++)
+			if (vecSizes[i] > 0)
+				iCount++;
+		return iCount;
+	}
+
+	std::uint32_t Label(int iCell) const { return vecLabels[iCell]; }
+
+	//both cells have to be walkable
+	bool Connected(int iCellA, int iCellB) const
+	{
+		return vecLabels[iCellA] == vecLabels[iCellB];
+	}
+
+	void Build(const PathfindingGrid& grid)
+	{
+		//label 0 counts nothing, the cells start there only so Relabel has something to take them from
+		vecLabels.assign(grid.Size(), 0);
+		vecSizes.assign(1, grid.Size());
+		for (int iCell = 0; iCell < grid.Size(); iCell++)
+		{
+			if (vecLabels[iCell] == 0 && grid.IsWalkable(grid.Position(iCell)))
+			{
+				Relabel(iCell, NewLabel());
+				Flood(grid, iCell);
+			}
+		}
+		vecSizes[0] = 0;
+	}
+
+	//the cell was just made walkable on the grid, it joins the regions around it and merges them
+	//the smaller regions are relabeled into the largest so the cost is the size of the smaller ones
+	void AddCell(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		int iCell = grid.Index(ivGridPos);
+		if (vecLabels[iCell] != 0)
+			return;
+
+		std::uint32_t iLargest = 0;
+		for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+		{
+			int iX = ivGridPos.x + GridDirection::iX[iDir], iY = ivGridPos.y + GridDirection::iY[iDir];
+			if (!grid.IsWalkable(iX, iY))
+				continue;
+			std::uint32_t iLabel = vecLabels[grid.Index(iX, iY)];
+			if (iLargest == 0 || vecSizes[iLabel] > vecSizes[iLargest])
+				iLargest = iLabel;
+		}
+		if (iLargest == 0)
+			iLargest = NewLabel();
+
+		vecSizes[0]++;
+		Relabel(iCell, iLargest);
+		Flood(grid, iCell);
+	}
+
+	//the cell was just made an obstacle on the grid, which can split its region in up to 4 parts
+	//nothing is flooded when the neighbors are connected right around the cell, otherwise every neighbor starts a flood
+	//with a label of its own and the floods take a cell each in turn, floods that meet are the same part and a part
+	//whose floods all ran out is split off, once a single part is still growing it is the rest of the region and goes
+	//back to the old label, so the cost is about the size of the parts that split off and not of the whole region
+	void RemoveCell(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		int iCell = grid.Index(ivGridPos);
+		std::uint32_t iOldLabel = vecLabels[iCell];
+		if (iOldLabel == 0)
+			return;
+		Relabel(iCell, 0);
+		vecSizes[0] = 0;
+		if (NeighborsConnected(grid, ivGridPos))
+			return;
+
+		//the floods get consecutive labels so the flood of a label is its offset from the first
+		int iFloods = 0;
+		std::uint32_t iFirstLabel = static_cast<std::uint32_t>(vecSizes.size());
+		int iParts[GridDirection::iCount];
+		vecVisited.clear();
+		for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+		{
+			int iX = ivGridPos.x + GridDirection::iX[iDir], iY = ivGridPos.y + GridDirection::iY[iDir];
+			if (!grid.IsWalkable(iX, iY) || vecLabels[grid.Index(iX, iY)] != iOldLabel)
+				continue;
+			Relabel(grid.Index(iX, iY), NewLabel());
+			vecFloods[iFloods].assign(1, grid.Index(iX, iY));
+			vecVisited.push_back(grid.Index(iX, iY));
+			iParts[iFloods] = iFloods;
+			iFloods++;
+		}
+		auto Part = [&](int iFlood) { while (iParts[iFlood] != iFlood) iFlood = iParts[iFlood]; return iFlood; };
+
+		int iGrowing = -1;
+		while (true)
+		{
+			//the part of the first flood still growing, -2 once a second part is growing too
+			iGrowing = -1;
+			for (int iFlood = 0; iFlood < iFloods && iGrowing != -2; iFlood++)
+				if (!vecFloods[iFlood].empty())
+					iGrowing = iGrowing == -1 || iGrowing == Part(iFlood) ? Part(iFlood) : -2;
+			if (iGrowing != -2)
+				break;
+
+			for (int iFlood = 0; iFlood < iFloods; iFlood++)
+			{
+				if (vecFloods[iFlood].empty())
+					continue;
+				glm::ivec2 ivPos = grid.Position(vecFloods[iFlood].back());
+				vecFloods[iFlood].pop_back();
+				for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+				{
+					int iX = ivPos.x + GridDirection::iX[iDir], iY = ivPos.y + GridDirection::iY[iDir];
+					if (!grid.IsWalkable(iX, iY))
+						continue;
+					int iNeighborCell = grid.Index(iX, iY);
+					std::uint32_t iLabel = vecLabels[iNeighborCell];
+					if (iLabel == iOldLabel)
+					{
+						Relabel(iNeighborCell, iFirstLabel + iFlood);
+						vecFloods[iFlood].push_back(iNeighborCell);
+						vecVisited.push_back(iNeighborCell);
+					}
+					else if (Part(iLabel - iFirstLabel) != Part(iFlood))
+						iParts[Part(iLabel - iFirstLabel)] = Part(iFlood);
+				}
+			}
+		}
+
+		//every split off part ends up on the label of its first flood
+		for (int iVisited : vecVisited)
+		{
+			int iPart = Part(vecLabels[iVisited] - iFirstLabel);
+			if (iPart == iGrowing)
+				Relabel(iVisited, iOldLabel);
+			else if (vecLabels[iVisited] != iFirstLabel + iPart)
+				Relabel(iVisited, iFirstLabel + iPart);
+		}
+		for (int iFlood = 0; iFlood < iFloods; iFlood++)
+			vecFloods[iFlood].clear();
+	}
+};
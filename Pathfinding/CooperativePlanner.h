@@ -0,0 +1,382 @@
+//WHCA*, windowed hierarchical cooperative A*, agents plan one after the other through space and time and reserve the
+//cell they will be on at every tick of their plan, the agents planning after them treat those as obstacles so no two
+//agents are ever on the same cell at the same tick or swap cells between two ticks
+//a plan only looks iWindow ticks ahead, the cost from its last cell on to the goal is read off the goal distance field of
+//the goal, the true distance on the level without the other agents, which stands in for the reverse resumable search of
+//the original, agents plan again once half their window is walked so they always have ticks reserved ahead of them
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+#include "PathfindingHeap.h"
+#include "ReservationTable.h"
+#include "GoalDistanceField.h"
+#include "SearchPolicy.h"
+
+//an agent parks on the last cell of its plan, it holds the cell for every tick after that until it plans again
+//so an agent whose turn was put off because the tick ran out of budget waits where it is instead of being walked into
+//agents that reached their goal stay parked on it and arent planned again until they get a new one, an agent without a
+//goal parks too but still plans around the reservations that were there before it, so it steps aside instead of being
+//parked on a cell another agent already holds
+//the agents must start on cells of their own, every plan is searched on the calling thread
+class CooperativePlanner
+{
+public:
+	struct Counters
+	{
+		std::size_t iTicks = 0, iPlans = 0, iExpansions = 0;
+		//agents that were due but had to wait for a later tick
+		std::size_t iDeferred = 0;
+		double fMicroseconds = 0.0;
+	};
+
+private:
+	struct Agent
+	{
+		std::uint32_t iAgent;
+		glm::ivec2 ivGoalPos;
+		bool bGoal, bReplan;
+		//the tick of vecWindow[0], the agent is on vecWindow[iTick - iPlannedTick] and parks on the last cell
+		std::uint32_t iPlannedTick;
+		std::vector<int> vecWindow;
+	};
+	std::vector<Agent> vecAgents;
+	std::unordered_map<std::uint32_t, std::size_t> mapAgents;
+	ReservationTable Reservations;
+	//agent parked on every cell and the tick it holds it from
+	std::vector<std::uint32_t> vecParked, vecParkedFrom;
+	std::uint32_t iTick = 0;
+	int iWindow = 16, iPlanBudget = 256;
+	SearchPolicy Policy;
+	std::int32_t iStraight = 1000, iDiagonal = 1414;
+	Counters counters;
+
+	//the space time states a plan can reach, the box of cells iWindow around the start for every tick of the window
+	//indexed ((tick * iSide) + y) * iSide + x relative to the corner of the box, stamped so a plan doesnt clear them
+	int iSide = 0;
+	std::vector<std::int32_t> vecG, vecParent;
+	std::vector<std::uint32_t> vecStamp;
+	std::uint32_t iStamp = 0;
+	PathfindingHeap<std::int32_t> OpenList;
+	//agents due this tick, and the steps of the plan being searched
+	std::vector<std::size_t> vecDue;
+	std::vector<int> vecSteps, vecOldWindow;
+
+	static constexpr std::uint32_t iNobody = ReservationTable::iNobody;
+
+	int Cell(const Agent& agent) const
+	{
+		std::size_t iStep = glm::min<std::size_t>(iTick - agent.iPlannedTick, agent.vecWindow.size() - 1);
+		return agent.vecWindow[iStep];
+	}
+
+	//on the goal and staying there for the rest of the window, waiting on the goal is free so a plan only leaves it to make
+	//way for an agent that reserved it earlier
+	bool AtGoal(const PathfindingGrid& grid, const Agent& agent) const
+	{
+		int iGoalCell = grid.Index(agent.ivGoalPos);
+		return Cell(agent) == iGoalCell && agent.vecWindow.back() == iGoalCell;
+	}
+
+	//anyone else on the cell at the tick, parked or passing through
+	bool Taken(int iCell, std::uint32_t iAtTick, std::uint32_t iAgent) const
+	{
+		std::uint32_t iParked = vecParked[iCell];
+		if (iParked != iNobody && iParked != iAgent && iAtTick >= vecParkedFrom[iCell])
+			return true;
+		std::uint32_t iHolder = Reservations.Holder(iCell, iAtTick);
+		return iHolder != iNobody && iHolder != iAgent;
+	}
+
+	//the ticks of the window still ahead and the parking spot
+	void Release(const PathfindingGrid& grid, const Agent& agent)
+	{
+		for (std::uint32_t iStep = iTick - agent.iPlannedTick; iStep < agent.vecWindow.size(); iStep++)
+			Reservations.Release(agent.vecWindow[iStep], agent.iPlannedTick + iStep, agent.iAgent);
+		int iParkCell = agent.vecWindow.back();
+		if (iParkCell < grid.Size() && vecParked[iParkCell] == agent.iAgent)
+			vecParked[iParkCell] = iNobody;
+	}
+
+	//a plan that came out of Search only has cells nobody else holds, the ones it keeps when every way was taken can
+	//run into other agents and dont take their ticks or their parking spots from them
+	void Hold(Agent& agent)
+	{
+		for (std::uint32_t iStep = iTick - agent.iPlannedTick; iStep < agent.vecWindow.size(); iStep++)
+			Reservations.Hold(agent.vecWindow[iStep], agent.iPlannedTick + iStep, agent.iAgent);
+		int iParkCell = agent.vecWindow.back();
+		if (vecParked[iParkCell] != iNobody && vecParked[iParkCell] != agent.iAgent)
+			return;
+		vecParked[iParkCell] = agent.iAgent;
+		vecParkedFrom[iParkCell] = agent.iPlannedTick + static_cast<std::uint32_t>(agent.vecWindow.size()) - 1;
+	}
+
+	//a space time A* from the cell of the agent over the next iWindow ticks, waiting is a step as well and costs a straight
+	//step anywhere but on the goal, the search ends on the first state at the end of the window that comes off the
+	//openlist, by then the agent has either reached the goal and waits there for free or got as close as the others let it
+	//without a field the agent has no goal and every cell is one, it waits for free and only steps aside for the plans
+	//of the others, false if every way is taken
+	bool Search(const PathfindingGrid& grid, const GoalDistanceField* pField, Agent& agent)
+	{
+		int iStartCell = Cell(agent), iGoalCell = pField ? grid.Index(agent.ivGoalPos) : -1;
+		glm::ivec2 ivCorner = grid.Position(iStartCell) - glm::ivec2(iWindow);
+		if (++iStamp == 0)
+		{
+			std::fill(vecStamp.begin(), vecStamp.end(), 0);
+			iStamp = 1;
+		}
+		OpenList.Clear();
+		auto Estimate = [&](int iCell) { return pField ? static_cast<std::int32_t>(pField->Cost(iCell) * static_cast<float>(iStraight) + 0.5f) : 0; };
+		auto State = [&](const glm::ivec2& ivPos, int iStep) { return (iStep * iSide + ivPos.y - ivCorner.y) * iSide + ivPos.x - ivCorner.x; };
+
+		int iStartState = State(grid.Position(iStartCell), 0);
+		vecStamp[iStartState] = iStamp;
+		vecG[iStartState] = 0;
+		vecParent[iStartState] = -1;
+		OpenList.Push(iStartState, Estimate(iStartCell), 0);
+		int iDirections = Policy.mConnectivity == CONNECTIVITY_4 ? 4 : GridDirection::iCount;
+		while (!OpenList.Empty())
+		{
+			int iState = OpenList.Pop().iCell;
+			counters.iExpansions++;
+			int iStep = iState / (iSide * iSide);
+			glm::ivec2 ivPos = ivCorner + glm::ivec2(iState % iSide, (iState / iSide) % iSide);
+			if (iStep == iWindow)
+			{
+				vecSteps.clear();
+				for (; iState != -1; iState = vecParent[iState])
+					vecSteps.push_back(grid.Index(ivCorner + glm::ivec2(iState % iSide, (iState / iSide) % iSide)));
+				agent.vecWindow.assign(vecSteps.rbegin(), vecSteps.rend());
+				agent.iPlannedTick = iTick;
+				return true;
+			}
+
+			int iCell = grid.Index(ivPos);
+			std::uint32_t iFromTick = iTick + iStep, iToTick = iFromTick + 1;
+			//the wait first, then the moves
+			for (int iDir = -1; iDir < iDirections; iDir++)
+			{
+				glm::ivec2 ivNextPos = ivPos;
+				std::int32_t Cost = iCell == iGoalCell || !pField ? 0 : iStraight;
+				if (iDir >= 0)
+				{
+					int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+					ivNextPos += glm::ivec2(iDX, iDY);
+					if (!grid.IsWalkable(ivNextPos))
+						continue;
+					bool bDiagonal = GridDirection::IsDiagonal(iDir);
+					if (bDiagonal && !Policy.bCornerCutting && (!grid.IsWalkable(ivPos.x + iDX, ivPos.y) || !grid.IsWalkable(ivPos.x, ivPos.y + iDY)))
+						continue;
+					Cost = bDiagonal ? iDiagonal : iStraight;
+				}
+				int iNextCell = grid.Index(ivNextPos);
+				if ((pField && pField->Cost(iNextCell) < 0.0f) || Taken(iNextCell, iToTick, agent.iAgent))
+					continue;
+				//two agents swapping cells pass through each other between the ticks
+				if (iDir >= 0)
+				{
+					std::uint32_t iOther = Reservations.Holder(iNextCell, iFromTick);
+					if (iOther != iNobody && iOther != agent.iAgent && Reservations.Holder(iCell, iToTick) == iOther)
+						continue;
+				}
+
+				int iNextState = State(ivNextPos, iStep + 1);
+				std::int32_t G = vecG[iState] + Cost;
+				if (vecStamp[iNextState] == iStamp)
+				{
+					if (G >= vecG[iNextState])
+						continue;
+					vecG[iNextState] = G;
+					vecParent[iNextState] = iState;
+					OpenList.DecreaseKey(iNextState, G + Estimate(iNextCell), G);
+					continue;
+				}
+				vecStamp[iNextState] = iStamp;
+				vecG[iNextState] = G;
+				vecParent[iNextState] = iState;
+				OpenList.Push(iNextState, G + Estimate(iNextCell), G);
+			}
+		}
+		return false;
+	}
+
+	template <class FieldSource>
+	void Plan(const PathfindingGrid& grid, FieldSource& fnField, Agent& agent)
+	{
+		counters.iPlans++;
+		agent.bReplan = false;
+		const GoalDistanceField* pField = agent.bGoal ? fnField(agent.ivGoalPos) : nullptr;
+		int iCell = Cell(agent);
+		Release(grid, agent);
+		std::uint32_t iOldTick = agent.iPlannedTick;
+		vecOldWindow.assign(agent.vecWindow.begin(), agent.vecWindow.end());
+		//a goal it cant get to is dropped, the agent parks where it is unless a plan of another agent runs over the cell
+		//and it has to make way, a stale field can be out of date about that so the goal is only put off until it isnt
+		if (!pField || !pField->Reaches(grid.Position(iCell)))
+		{
+			agent.bGoal = pField && pField->Stale();
+			pField = nullptr;
+		}
+		if (!Search(grid, pField, agent))
+		{
+			agent.vecWindow.assign(vecOldWindow.begin(), vecOldWindow.end());
+			agent.iPlannedTick = iOldTick;
+		}
+		Hold(agent);
+	}
+
+public:
+	const Counters& GetCounters() const { return counters; }
+	void ResetCounters() { counters = Counters(); }
+	std::size_t Count() const { return vecAgents.size(); }
+	std::uint32_t GetTick() const { return iTick; }
+
+	//ticks every plan looks ahead, a longer window sees further around the others and costs more per plan
+	void SetWindow(int iWindow)
+	{
+		this->iWindow = glm::max(iWindow, 2);
+		iSide = 2 * this->iWindow + 1;
+		std::size_t iStates = static_cast<std::size_t>(iSide) * iSide * (this->iWindow + 1);
+		vecG.assign(iStates, 0);
+		vecParent.assign(iStates, -1);
+		vecStamp.assign(iStates, 0);
+		iStamp = 0;
+		OpenList.Resize(static_cast<int>(iStates));
+	}
+	int GetWindow() const { return iWindow; }
+	//plans per tick at most, the agents that are due longest go first and the rest wait parked for the next tick
+	void SetPlanBudget(int iPlanBudget) { this->iPlanBudget = glm::max(iPlanBudget, 1); }
+
+	//the level the agents are on, every agent is dropped
+	void Resize(const PathfindingGrid& grid, const SearchPolicy& policy)
+	{
+		Clear();
+		Reservations.Resize(grid.Size());
+		vecParked.assign(grid.Size(), iNobody);
+		vecParkedFrom.assign(grid.Size(), 0);
+		Policy = policy;
+		iStraight = policy.mCostType == COST_INTEGER ? SearchPolicies::IntegerCost::Straight : SearchPolicies::FineIntegerCost::Straight;
+		iDiagonal = policy.mCostType == COST_INTEGER ? SearchPolicies::IntegerCost::Diagonal : SearchPolicies::FineIntegerCost::Diagonal;
+		if (iSide == 0)
+			SetWindow(iWindow);
+	}
+
+	void Clear()
+	{
+		vecAgents.clear();
+		mapAgents.clear();
+		Reservations.Clear();
+		std::fill(vecParked.begin(), vecParked.end(), iNobody);
+		iTick = 0;
+	}
+
+	//an agent standing on a cell, parked there until it gets a goal
+	void AddAgent(const PathfindingGrid& grid, std::uint32_t iAgent, const glm::ivec2& ivGridPos)
+	{
+		if (mapAgents.count(iAgent) || !grid.InBounds(ivGridPos.x, ivGridPos.y))
+			return;
+		mapAgents[iAgent] = vecAgents.size();
+		vecAgents.push_back(Agent{ iAgent, ivGridPos, false, false, iTick, std::vector<int>(1, grid.Index(ivGridPos)) });
+		Hold(vecAgents.back());
+		Reservations.Presize(vecAgents.size() * (iWindow + 2));
+	}
+
+	void RemoveAgent(const PathfindingGrid& grid, std::uint32_t iAgent)
+	{
+		auto it = mapAgents.find(iAgent);
+		if (it == mapAgents.end())
+			return;
+		std::size_t iIndex = it->second;
+		Release(grid, vecAgents[iIndex]);
+		mapAgents.erase(it);
+		if (iIndex != vecAgents.size() - 1)
+		{
+			vecAgents[iIndex] = std::move(vecAgents.back());
+			mapAgents[vecAgents[iIndex].iAgent] = iIndex;
+		}
+		vecAgents.pop_back();
+	}
+
+	bool HasAgent(std::uint32_t iAgent) const { return mapAgents.count(iAgent) != 0; }
+
+	//planned on the next tick ahead of the agents that are only due
+	void SetGoal(std::uint32_t iAgent, const glm::ivec2& ivGoalPos)
+	{
+		auto it = mapAgents.find(iAgent);
+		if (it == mapAgents.end())
+			return;
+		Agent& agent = vecAgents[it->second];
+		agent.ivGoalPos = ivGoalPos;
+		agent.bGoal = true;
+		agent.bReplan = true;
+	}
+
+	//the cell the agent is on at the current tick
+	glm::ivec2 Position(const PathfindingGrid& grid, std::uint32_t iAgent) const
+	{
+		auto it = mapAgents.find(iAgent);
+		return it == mapAgents.end() ? glm::ivec2(-1) : grid.Position(Cell(vecAgents[it->second]));
+	}
+
+	//a tile became a wall, the agents whose plans run over it plan again first thing on the next tick
+	void TileChanged(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		if (grid.IsWalkable(ivGridPos))
+			return;
+		int iCell = grid.Index(ivGridPos);
+		for (auto& agent : vecAgents)
+			if (std::find(agent.vecWindow.begin() + glm::min<std::size_t>(iTick - agent.iPlannedTick, agent.vecWindow.size() - 1), agent.vecWindow.end(), iCell) != agent.vecWindow.end())
+				agent.bReplan = agent.bGoal;
+	}
+
+	//plans the agents that are due, at most iPlanBudget of them, and moves every agent on to its cell of the next tick
+	//fnField gives the GoalDistanceField of a goal cell, nullptr if there is none
+	template <class FieldSource>
+	void Tick(const PathfindingGrid& grid, FieldSource&& fnField)
+	{
+		auto timeStart = std::chrono::steady_clock::now();
+		//half the window walked, a new goal or a plan cut by a wall
+		vecDue.clear();
+		std::uint32_t iHalf = static_cast<std::uint32_t>(iWindow / 2);
+		for (std::size_t iIndex = 0; iIndex < vecAgents.size(); iIndex++)
+		{
+			const Agent& agent = vecAgents[iIndex];
+			if (agent.bReplan || (agent.bGoal && !AtGoal(grid, agent) && iTick - agent.iPlannedTick >= iHalf))
+				vecDue.push_back(iIndex);
+		}
+		std::size_t iPlans = glm::min<std::size_t>(vecDue.size(), static_cast<std::size_t>(iPlanBudget));
+		if (iPlans < vecDue.size())
+		{
+			std::partial_sort(vecDue.begin(), vecDue.begin() + iPlans, vecDue.end(), [&](std::size_t a, std::size_t b)
+			{
+				const Agent& agentA = vecAgents[a], & agentB = vecAgents[b];
+				if (agentA.bReplan != agentB.bReplan)
+					return agentA.bReplan;
+				return agentA.iPlannedTick < agentB.iPlannedTick;
+			});
+			counters.iDeferred += vecDue.size() - iPlans;
+		}
+		for (std::size_t iPlan = 0; iPlan < iPlans; iPlan++)
+			Plan(grid, fnField, vecAgents[vecDue[iPlan]]);
+
+		//the reservations of the tick that is over
+		for (auto& agent : vecAgents)
+			Reservations.Release(Cell(agent), iTick, agent.iAgent);
+		iTick++;
+		counters.iTicks++;
+		counters.fMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - timeStart).count();
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		std::size_t iBytes = Reservations.MemoryUsage() + (vecParked.capacity() + vecParkedFrom.capacity() + vecStamp.capacity()) * sizeof(std::uint32_t)
+			+ (vecG.capacity() + vecParent.capacity()) * sizeof(std::int32_t) + OpenList.MemoryUsage() + vecAgents.capacity() * sizeof(Agent);
+		for (auto& agent : vecAgents)
+			iBytes += agent.vecWindow.capacity() * sizeof(int);
+		return iBytes;
+	}
+};
@@ -0,0 +1,325 @@
+//D* Lite, an incremental planner that keeps its search between queries of the same agent and only repairs what changed
+//it searches from the goal towards the agent, so the costs it keeps are costs to the goal and stay valid while the agent
+//walks, the agent moving only shifts the heuristic, which the key offset iKM makes up for instead of reordering the openlist
+//a changed tile only touches the cells around it and a target that moves a few tiles becomes the new root of the
+//search, both are put back on the openlist and the search runs until the agent is consistent again, every cell whose
+//cost to the goal didnt change keeps it
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingNode.h"
+#include "PathfindingGrid.h"
+#include "PathfindingHeap.h"
+#include "SearchPolicy.h"
+
+//costs are in the fixed point units of the level, 10/14 with COST_INTEGER and 1000/1414 otherwise, which is what
+//COST_FLOAT rounds to, the heuristic is octile on 8 connected grids and manhattan on 4 connected ones, both consistent
+//every cell keeps g, rhs and a generation stamp, 13 bytes per cell for every agent that has a planner
+class DStarLite
+{
+	struct Key
+	{
+		std::int32_t k1, k2;
+		bool operator<(const Key& other) const { return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2); }
+	};
+
+	std::vector<std::int32_t> vecG, vecRHS;
+	std::vector<std::uint32_t> vecGeneration;
+	std::vector<std::uint8_t> vecOpen;
+	std::uint32_t iGeneration = 0;
+	//F is the first key and G the second one negated, the heap breaks ties of F on the larger G, so on the smaller key
+	PathfindingHeap<std::int32_t> OpenList;
+	SearchPolicy Policy;
+	std::int32_t iStraight = 1000, iDiagonal = 1414;
+	glm::ivec2 ivStartPos, ivGoalPos;
+	//where the agent was when the keys on the openlist were last offset, and the offset
+	glm::ivec2 ivLastPos;
+	std::int32_t iKM = 0;
+	bool bPlanned = false;
+	//expansions of the current Plan and the cells they were on if those are kept
+	std::size_t iExpansions = 0;
+	std::vector<std::int32_t>* pVisited = nullptr;
+
+	//cells not stamped with the current generation were never touched since the last reset
+	void Touch(int iCell)
+	{
+		if (vecGeneration[iCell] == iGeneration)
+			return;
+		vecGeneration[iCell] = iGeneration;
+		vecG[iCell] = vecRHS[iCell] = iInfinity;
+		vecOpen[iCell] = 0;
+	}
+	std::int32_t G(int iCell) const { return vecGeneration[iCell] == iGeneration ? vecG[iCell] : iInfinity; }
+	std::int32_t RHS(int iCell) const { return vecGeneration[iCell] == iGeneration ? vecRHS[iCell] : iInfinity; }
+
+	std::int32_t H(const glm::ivec2& ivFrom, const glm::ivec2& ivTo) const
+	{
+		int iDX = glm::abs(ivFrom.x - ivTo.x), iDY = glm::abs(ivFrom.y - ivTo.y);
+		if (Policy.mConnectivity == CONNECTIVITY_4)
+			return iStraight * (iDX + iDY);
+		return iStraight * (iDX + iDY) + (iDiagonal - 2 * iStraight) * glm::min(iDX, iDY);
+	}
+
+	Key CalculateKey(const PathfindingGrid& grid, int iCell) const
+	{
+		std::int32_t iMin = glm::min(G(iCell), RHS(iCell));
+		return Key{ iMin + H(ivStartPos, grid.Position(iCell)) + iKM, iMin };
+	}
+
+	//the steps from a cell with their cost, the grid is undirected so they are also the steps into it, none from an obstacle
+	int Steps(const PathfindingGrid& grid, int iCell, int* arrCells, std::int32_t* arrCosts) const
+	{
+		glm::ivec2 ivPos = grid.Position(iCell);
+		if (!grid.IsWalkable(ivPos))
+			return 0;
+		int iDirections = Policy.mConnectivity == CONNECTIVITY_4 ? 4 : GridDirection::iCount;
+		int iCount = 0;
+		for (int iDir = 0; iDir < iDirections; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			if (!grid.IsWalkable(ivPos.x + iDX, ivPos.y + iDY))
+				continue;
+			bool bDiagonal = GridDirection::IsDiagonal(iDir);
+			if (bDiagonal && !Policy.bCornerCutting && (!grid.IsWalkable(ivPos.x + iDX, ivPos.y) || !grid.IsWalkable(ivPos.x, ivPos.y + iDY)))
+				continue;
+			arrCells[iCount] = grid.Index(ivPos.x + iDX, ivPos.y + iDY);
+			arrCosts[iCount++] = bDiagonal ? iDiagonal : iStraight;
+		}
+		return iCount;
+	}
+
+	//the cheapest way to the goal through a neighbor
+	std::int32_t LeastRHS(const PathfindingGrid& grid, int iCell) const
+	{
+		int arrCells[GridDirection::iCount];
+		std::int32_t arrCosts[GridDirection::iCount];
+		int iSteps = Steps(grid, iCell, arrCells, arrCosts);
+		std::int32_t iLeast = iInfinity;
+		for (int iStep = 0; iStep < iSteps; iStep++)
+			if (G(arrCells[iStep]) < iInfinity)
+				iLeast = glm::min(iLeast, G(arrCells[iStep]) + arrCosts[iStep]);
+		return iLeast;
+	}
+
+	//an inconsistent cell is on the openlist with its current key, a consistent one isnt
+	void UpdateVertex(const PathfindingGrid& grid, int iCell)
+	{
+		Touch(iCell);
+		if (vecG[iCell] != vecRHS[iCell])
+		{
+			Key key = CalculateKey(grid, iCell);
+			if (vecOpen[iCell])
+				OpenList.Update(iCell, key.k1, -key.k2);
+			else
+				OpenList.Push(iCell, key.k1, -key.k2);
+			vecOpen[iCell] = 1;
+		}
+		else if (vecOpen[iCell])
+		{
+			OpenList.Remove(iCell);
+			vecOpen[iCell] = 0;
+		}
+	}
+
+	void SetRHS(int iCell, std::int32_t iRHS)
+	{
+		Touch(iCell);
+		vecRHS[iCell] = iRHS;
+	}
+
+	//the cell is no longer the goal or a step next to it changed, its rhs is worked out again from its neighbors
+	void Recompute(const PathfindingGrid& grid, int iCell)
+	{
+		if (iCell != grid.Index(ivGoalPos))
+			SetRHS(iCell, LeastRHS(grid, iCell));
+		UpdateVertex(grid, iCell);
+	}
+
+	//false if it stopped after iMaxExpansions with the start not consistent yet, a negative count runs it to the end
+	//cells that only get their key updated count against it too, after a long walk nearly every queued key is stale
+	bool ComputeShortestPath(const PathfindingGrid& grid, int iMaxExpansions)
+	{
+		int iStartCell = grid.Index(ivStartPos), iGoalCell = grid.Index(ivGoalPos);
+		int arrCells[GridDirection::iCount];
+		std::int32_t arrCosts[GridDirection::iCount];
+		int iPops = 0;
+		while (!OpenList.Empty())
+		{
+			Key keyOld{ OpenList.Top().F, -OpenList.Top().G };
+			if (!(keyOld < CalculateKey(grid, iStartCell)) && RHS(iStartCell) <= G(iStartCell))
+				break;
+			if (iMaxExpansions >= 0 && iPops++ >= iMaxExpansions)
+				return false;
+			int iCell = OpenList.Top().iCell;
+			Key keyNew = CalculateKey(grid, iCell);
+			//the agent moved since the cell was queued
+			if (keyOld < keyNew)
+			{
+				OpenList.Update(iCell, keyNew.k1, -keyNew.k2);
+				continue;
+			}
+
+			iExpansions++;
+			if (pVisited)
+				pVisited->push_back(iCell);
+			int iSteps = Steps(grid, iCell, arrCells, arrCosts);
+			if (vecG[iCell] > vecRHS[iCell])
+			{
+				//overconsistent, its cost went down and the neighbors can take the cheaper way
+				vecG[iCell] = vecRHS[iCell];
+				OpenList.Pop();
+				vecOpen[iCell] = 0;
+				for (int iStep = 0; iStep < iSteps; iStep++)
+				{
+					int iNextCell = arrCells[iStep];
+					if (iNextCell != iGoalCell && vecG[iCell] + arrCosts[iStep] < RHS(iNextCell))
+						SetRHS(iNextCell, vecG[iCell] + arrCosts[iStep]);
+					UpdateVertex(grid, iNextCell);
+				}
+			}
+			else
+			{
+				//underconsistent, its cost went up and every neighbor that went through it looks for another way
+				std::int32_t iOldG = vecG[iCell];
+				vecG[iCell] = iInfinity;
+				for (int iStep = 0; iStep < iSteps; iStep++)
+				{
+					int iNextCell = arrCells[iStep];
+					if (iNextCell != iGoalCell && RHS(iNextCell) == iOldG + arrCosts[iStep])
+						SetRHS(iNextCell, LeastRHS(grid, iNextCell));
+					UpdateVertex(grid, iNextCell);
+				}
+				UpdateVertex(grid, iCell);
+			}
+		}
+		return true;
+	}
+
+	//forgets the search and starts over with only the goal queued
+	void Reset(const PathfindingGrid& grid)
+	{
+		if (++iGeneration == 0)
+		{
+			std::fill(vecGeneration.begin(), vecGeneration.end(), 0);
+			iGeneration = 1;
+		}
+		OpenList.Clear();
+		iKM = 0;
+		ivLastPos = ivStartPos;
+		bPlanned = true;
+		int iGoalCell = grid.Index(ivGoalPos);
+		SetRHS(iGoalCell, 0);
+		UpdateVertex(grid, iGoalCell);
+	}
+
+public:
+	static constexpr std::int32_t iInfinity = 0x3FFFFFFF;
+
+	void Resize(int iCells, const SearchPolicy& policy)
+	{
+		vecG.assign(iCells, iInfinity);
+		vecRHS.assign(iCells, iInfinity);
+		vecGeneration.assign(iCells, 0);
+		vecOpen.assign(iCells, 0);
+		iGeneration = 0;
+		OpenList.Resize(iCells);
+		Policy = policy;
+		iStraight = policy.mCostType == COST_INTEGER ? SearchPolicies::IntegerCost::Straight : SearchPolicies::FineIntegerCost::Straight;
+		iDiagonal = policy.mCostType == COST_INTEGER ? SearchPolicies::IntegerCost::Diagonal : SearchPolicies::FineIntegerCost::Diagonal;
+		bPlanned = false;
+	}
+
+	//plans from ivStartPos to ivGoalPos reusing the last plan, a goal more than iRepairRadius tiles from the last one
+	//starts over since nearly every cost to it changed
+	//the plan is made by Continue, a few expansions at a time until it returns true, everything in between is kept in
+	//the planner so a tile can change or a newer query begin again before the last one finished
+	void Begin(const PathfindingGrid& grid, const glm::ivec2& ivStartPos, const glm::ivec2& ivGoalPos, int iRepairRadius)
+	{
+		iExpansions = 0;
+		this->ivStartPos = ivStartPos;
+		glm::ivec2 ivOldGoalPos = this->ivGoalPos;
+		this->ivGoalPos = ivGoalPos;
+		glm::ivec2 ivMoved = glm::abs(ivGoalPos - ivOldGoalPos);
+		if (!bPlanned || glm::max(ivMoved.x, ivMoved.y) > iRepairRadius)
+			Reset(grid);
+		else
+		{
+			//the heuristic of every queued key shrank by at most what the agent moved, the new keys are offset by as much
+			iKM += H(ivLastPos, ivStartPos);
+			ivLastPos = ivStartPos;
+			if (ivGoalPos != ivOldGoalPos)
+			{
+				SetRHS(grid.Index(ivGoalPos), 0);
+				UpdateVertex(grid, grid.Index(ivGoalPos));
+				Recompute(grid, grid.Index(ivOldGoalPos));
+			}
+		}
+	}
+
+	//expands at most iMaxExpansions cells, a negative count runs it to the end, and adds them to pVisited if it is set
+	bool Continue(const PathfindingGrid& grid, int iMaxExpansions, std::vector<std::int32_t>* pVisited = nullptr)
+	{
+		this->pVisited = pVisited;
+		bool bDone = ComputeShortestPath(grid, iMaxExpansions);
+		this->pVisited = nullptr;
+		return bDone;
+	}
+
+	//cells expanded since the last Begin
+	std::size_t Expansions() const { return iExpansions; }
+
+	//a tile changed, the steps of it and of every neighbor are worked out again on the next Plan
+	void TileChanged(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		if (!bPlanned)
+			return;
+		for (int iDY = -1; iDY <= 1; iDY++)
+			for (int iDX = -1; iDX <= 1; iDX++)
+				if (grid.InBounds(ivGridPos.x + iDX, ivGridPos.y + iDY))
+					Recompute(grid, grid.Index(ivGridPos.x + iDX, ivGridPos.y + iDY));
+	}
+
+	//the planned path in the form the searches give it, target first without the start, every step goes to the neighbor
+	//that is the cheapest way on, false if the goal cant be reached
+	bool Path(const PathfindingGrid& grid, std::vector<PathfindingNode>& vecPath, float& fCost) const
+	{
+		//the search stops once the start is as cheap as its rhs says, which can be before its g caught up
+		int iCell = grid.Index(ivStartPos), iGoalCell = grid.Index(ivGoalPos);
+		std::int32_t iRemaining = RHS(iCell);
+		if (!bPlanned || iRemaining >= iInfinity)
+			return false;
+		float fUnit = static_cast<float>(iStraight);
+		fCost = static_cast<float>(iRemaining) / fUnit;
+		std::size_t iBegin = vecPath.size();
+		std::int32_t iWalked = 0;
+		int arrCells[GridDirection::iCount];
+		std::int32_t arrCosts[GridDirection::iCount];
+		while (iCell != iGoalCell)
+		{
+			int iSteps = Steps(grid, iCell, arrCells, arrCosts), iBest = -1;
+			for (int iStep = 0; iStep < iSteps; iStep++)
+				if (G(arrCells[iStep]) < iInfinity && (iBest == -1 || G(arrCells[iStep]) + arrCosts[iStep] < G(arrCells[iBest]) + arrCosts[iBest]))
+					iBest = iStep;
+			//only with a plan that wasnt repaired after the level changed
+			if (iBest == -1 || G(arrCells[iBest]) >= iRemaining)
+			{
+				vecPath.resize(iBegin);
+				return false;
+			}
+			iCell = arrCells[iBest];
+			iRemaining = G(iCell);
+			iWalked += arrCosts[iBest];
+			vecPath.push_back(PathfindingNode(grid.Position(iCell), static_cast<float>(iWalked) / fUnit));
+		}
+		std::reverse(vecPath.begin() + iBegin, vecPath.end());
+		return true;
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return (vecG.capacity() + vecRHS.capacity()) * sizeof(std::int32_t) + vecGeneration.capacity() * sizeof(std::uint32_t)
+			+ vecOpen.capacity() + OpenList.MemoryUsage();
+	}
+};
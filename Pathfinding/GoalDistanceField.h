@@ -0,0 +1,318 @@
+//the cost from every cell to one goal cell, a dijkstra from the goal over the whole region it is in
+//the grid is undirected so that is also the cost from every cell to the goal, and a path to the goal from anywhere
+//is a walk downhill, every step to the neighbor whose cost plus the step is the cost of the cell, no search at all
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingNode.h"
+#include "PathfindingGrid.h"
+#include "SearchContext.h"
+#include "SearchKernel.h"
+#include "SearchPolicy.h"
+
+//the dijkstra of a field, with the entry points of a search so SelectSearchKernel compiles it for the level policy
+//it starts at the target and expands until the openlist is empty, the start isnt used
+//the costs are left in the G of the search space, for the integer cost types they are turned into floats in vecG
+//once it is done so the field reads them the same way for every cost type
+template <class Connectivity, class Corners, class Heuristic, class Cost, class OpenListType>
+struct GoalFieldKernel
+{
+	typedef SearchKernel<Connectivity, Corners, SearchPolicies::Zero, Cost, OpenListType> Kernel;
+	typedef typename Cost::Type CostType;
+
+	static void Begin(const PathfindingGrid& grid, SearchContext& context, const glm::ivec2&, const glm::ivec2& ivTargetPos)
+	{
+		Kernel::Begin(grid, context, ivTargetPos, ivTargetPos);
+	}
+
+	static SearchStatus Continue(const PathfindingGrid& grid, SearchContext& context, PathResult&, const glm::ivec2&, const glm::ivec2&, int iMaxExpansions)
+	{
+		OpenListType& openList = context.template OpenListOf<OpenListType>();
+		for (int iExpansions = 0; iMaxExpansions < 0 || iExpansions < iMaxExpansions; iExpansions++)
+		{
+			if (openList.Empty())
+			{
+				ToFloat(grid, context);
+				return SEARCH_FOUND;
+			}
+			int iCurrentCell = openList.Pop().iCell;
+			context.iExpansions++;
+			Kernel::Expand(grid, context, openList, iCurrentCell, [](int, int) { return CostType(0); }, [](int) {});
+		}
+		return SEARCH_RUNNING;
+	}
+
+	static void ToFloat(const PathfindingGrid& grid, SearchContext& context)
+	{
+		if (!std::is_same<CostType, float>::value)
+			for (int iCell = 0; iCell < grid.Size(); iCell++)
+				if (context.SearchSpace.State(iCell) != NODE_NONE)
+					context.SearchSpace.vecG[iCell] = Cost::ToFloat(context.SearchSpace.template Costs<CostType>()[iCell]);
+	}
+};
+
+//the costs are floats in tiles like PathResult::fCost, negative for cells the goal cant be reached from
+//next to them is the direction of the step downhill from every cell, so the field is also a flow field any number of
+//agents heading for the goal can follow one step at a time without a path of their own
+//5 bytes per cell, a level of 512x512 is a bit over a megabyte per field
+class GoalDistanceField
+{
+	glm::ivec2 ivGoalPos;
+	int iWidth = 0, iHeight = 0;
+	//the level changed since it was built, it is still a fine heuristic but its steps can lead into a new wall
+	bool bStale = false;
+	std::vector<float> vecCosts;
+	//GridDirection of the step from the cell, iNoDirection on the goal and cells it cant be reached from
+	std::vector<std::uint8_t> vecDirections;
+
+	static constexpr std::uint8_t iNoDirection = 0xFF;
+
+	//the neighbor that is the cheapest way on to the goal, which is a step of a shortest path, -1 if there is none
+	int BestStep(const PathfindingGrid& grid, const SearchPolicy& policy, float fStraight, float fDiagonal, int iCell) const
+	{
+		glm::ivec2 ivPos = grid.Position(iCell);
+		int iDirections = policy.mConnectivity == CONNECTIVITY_4 ? 4 : GridDirection::iCount;
+		int iBestDir = -1;
+		float fBest = std::numeric_limits<float>::max();
+		for (int iDir = 0; iDir < iDirections; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			if (!grid.IsWalkable(ivPos.x + iDX, ivPos.y + iDY))
+				continue;
+			bool bDiagonal = GridDirection::IsDiagonal(iDir);
+			if (bDiagonal && !policy.bCornerCutting && (!grid.IsWalkable(ivPos.x + iDX, ivPos.y) || !grid.IsWalkable(ivPos.x, ivPos.y + iDY)))
+				continue;
+			float fThrough = vecCosts[grid.Index(ivPos.x + iDX, ivPos.y + iDY)] + (bDiagonal ? fDiagonal : fStraight);
+			if (fThrough < fBest)
+			{
+				fBest = fThrough;
+				iBestDir = iDir;
+			}
+		}
+		return iBestDir;
+	}
+
+public:
+	static constexpr float fUnreachable = -1.0f;
+
+	const glm::ivec2& Goal() const { return ivGoalPos; }
+	int Width() const { return iWidth; }
+	int Height() const { return iHeight; }
+	bool Stale() const { return bStale; }
+	void MarkStale() { bStale = true; }
+
+	//the cost of walking from the cell to the goal
+	float Cost(int iCell) const { return vecCosts[iCell]; }
+	float Cost(const glm::ivec2& ivGridPos) const { return vecCosts[ivGridPos.y * iWidth + ivGridPos.x]; }
+	bool Reaches(const glm::ivec2& ivGridPos) const
+	{
+		return ivGridPos.x >= 0 && ivGridPos.y >= 0 && ivGridPos.x < iWidth && ivGridPos.y < iHeight && Cost(ivGridPos) >= 0.0f;
+	}
+
+	//the cell to step to from ivGridPos, false on the goal and where the goal cant be reached from
+	bool Next(const glm::ivec2& ivGridPos, glm::ivec2& ivNextPos) const
+	{
+		if (!Reaches(ivGridPos))
+			return false;
+		std::uint8_t iDir = vecDirections[ivGridPos.y * iWidth + ivGridPos.x];
+		if (iDir == iNoDirection)
+			return false;
+		ivNextPos = glm::ivec2(ivGridPos.x + GridDirection::iX[iDir], ivGridPos.y + GridDirection::iY[iDir]);
+		return true;
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecCosts.capacity() * sizeof(float) + vecDirections.capacity() * sizeof(std::uint8_t) + sizeof(GoalDistanceField);
+	}
+
+	//floods the level from the goal in the context with the kernel SelectSearchKernel<GoalFieldKernel> gave for the policy
+	//and points every cell it reached downhill
+	void Build(const PathfindingGrid& grid, SearchContext& context, const SearchPolicy& policy, const SearchKernelFunctions& flood, const glm::ivec2& ivGoalPos)
+	{
+		this->ivGoalPos = ivGoalPos;
+		bStale = false;
+		iWidth = grid.Width();
+		iHeight = grid.Height();
+		vecCosts.assign(grid.Size(), fUnreachable);
+		vecDirections.assign(grid.Size(), iNoDirection);
+		if (!grid.IsWalkable(ivGoalPos))
+			return;
+
+		PathResult result;
+		context.iExpansions = 0;
+		context.SearchSpace.bRecordVisited = false;
+		flood.fnBegin(grid, context, ivGoalPos, ivGoalPos);
+		flood.fnContinue(grid, context, result, ivGoalPos, ivGoalPos, -1);
+		for (int iCell = 0; iCell < grid.Size(); iCell++)
+			if (context.SearchSpace.State(iCell) != NODE_NONE)
+				vecCosts[iCell] = context.SearchSpace.vecG[iCell];
+
+		float fStraight = PathCost(policy.mCostType, 1, 0), fDiagonal = PathCost(policy.mCostType, 0, 1);
+		int iGoalCell = grid.Index(ivGoalPos);
+		for (int iCell = 0; iCell < grid.Size(); iCell++)
+			if (vecCosts[iCell] >= 0.0f && iCell != iGoalCell)
+				vecDirections[iCell] = static_cast<std::uint8_t>(BestStep(grid, policy, fStraight, fDiagonal, iCell));
+	}
+
+	//the path from the start to the goal in the form the searches give it, target first without the start, and its cost
+	//the steps only go downhill so the walk is as long as the path and cant go in circles
+	//false if the goal cant be reached from the start
+	bool Descend(const glm::ivec2& ivStartPos, std::vector<PathfindingNode>& vecPath, float& fCost) const
+	{
+		if (!Reaches(ivStartPos))
+			return false;
+		fCost = Cost(ivStartPos);
+		std::size_t iBegin = vecPath.size();
+		for (glm::ivec2 ivCurrentPos = ivStartPos; Next(ivCurrentPos, ivCurrentPos);)
+			vecPath.push_back(PathfindingNode(ivCurrentPos, fCost - Cost(ivCurrentPos)));
+		std::reverse(vecPath.begin() + iBegin, vecPath.end());
+		return true;
+	}
+};
+
+//fields by goal cell, the least recently used one that isnt pinned or held is dropped once there are more than iCapacity
+//Find only reads so searches on other threads can use the fields, anything that adds or drops one has to wait for them
+class GoalDistanceFieldCache
+{
+	struct Entry
+	{
+		int iCell;
+		bool bPinned;
+		//agents following the field, a held field is kept like a pinned one
+		int iHolds;
+		std::uint64_t iLastUse;
+		std::unique_ptr<GoalDistanceField> field;
+
+		bool Kept() const { return bPinned || iHolds > 0; }
+	};
+	std::vector<Entry> vecEntries;
+	std::size_t iCapacity = 8;
+	std::uint64_t iUses = 0;
+
+	void Evict()
+	{
+		while (true)
+		{
+			std::size_t iUnpinned = 0, iOldest = vecEntries.size();
+			for (std::size_t iEntry = 0; iEntry < vecEntries.size(); iEntry++)
+			{
+				if (vecEntries[iEntry].Kept())
+					continue;
+				iUnpinned++;
+				if (iOldest == vecEntries.size() || vecEntries[iEntry].iLastUse < vecEntries[iOldest].iLastUse)
+					iOldest = iEntry;
+			}
+			if (iUnpinned <= iCapacity)
+				return;
+			vecEntries.erase(vecEntries.begin() + iOldest);
+		}
+	}
+
+public:
+	bool Empty() const { return vecEntries.empty(); }
+	std::size_t Count() const { return vecEntries.size(); }
+
+	//unpinned fields kept at most, the pinned and held ones dont count against it, at least the one just built is kept
+	void SetCapacity(std::size_t iCapacity)
+	{
+		this->iCapacity = glm::max<std::size_t>(iCapacity, 1);
+		Evict();
+	}
+
+	const GoalDistanceField* Find(int iCell) const
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell)
+				return entry.field.get();
+		return nullptr;
+	}
+
+	//Find that counts as a use
+	const GoalDistanceField* Use(int iCell)
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell)
+			{
+				entry.iLastUse = ++iUses;
+				return entry.field.get();
+			}
+		return nullptr;
+	}
+
+	//the field of the cell to build into, a new one if there is none, its old field is replaced
+	GoalDistanceField& Insert(int iCell, bool bPinned)
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell)
+			{
+				entry.bPinned = entry.bPinned || bPinned;
+				entry.iLastUse = ++iUses;
+				return *entry.field;
+			}
+		vecEntries.push_back(Entry{ iCell, bPinned, 0, ++iUses, std::make_unique<GoalDistanceField>() });
+		GoalDistanceField& field = *vecEntries.back().field;
+		//the new entry is the most recently used, it is never the one dropped
+		Evict();
+		return field;
+	}
+
+	//holds dont drop anything, a released field is only dropped by the next Insert so a release doesnt have to wait
+	//for the searches on other threads
+	void Hold(int iCell)
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell)
+				entry.iHolds++;
+	}
+
+	void Release(int iCell)
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell && entry.iHolds > 0)
+				entry.iHolds--;
+	}
+
+	void MarkStale()
+	{
+		for (auto& entry : vecEntries)
+			entry.field->MarkStale();
+	}
+
+	//swaps in a field built somewhere else for the goal, the old one is left in field, nothing if the goal was dropped
+	void Replace(int iCell, GoalDistanceField& field)
+	{
+		for (auto& entry : vecEntries)
+			if (entry.iCell == iCell)
+				std::swap(*entry.field, field);
+	}
+
+	void Goals(std::vector<glm::ivec2>& vecGoals) const
+	{
+		for (auto& entry : vecEntries)
+			vecGoals.push_back(entry.field->Goal());
+	}
+
+	void Erase(int iCell)
+	{
+		vecEntries.erase(std::remove_if(vecEntries.begin(), vecEntries.end(), [iCell](const Entry& entry) { return entry.iCell == iCell; }), vecEntries.end());
+	}
+
+	void Clear()
+	{
+		vecEntries.clear();
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		std::size_t iBytes = vecEntries.capacity() * sizeof(Entry);
+		for (auto& entry : vecEntries)
+			iBytes += entry.field->MemoryUsage();
+		return iBytes;
+	}
+};
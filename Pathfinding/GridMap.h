@@ -0,0 +1,149 @@
+//a level loaded from disk without any of the app around it, for the headless tools
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm.hpp>
+#include "Pathfinder.h"
+
+struct GridMap
+{
+	int iWidth = 0, iHeight = 0;
+	//one per cell, y * width + x
+	std::vector<std::uint8_t> vecWalkable;
+	//the spawn and stairs tiles of the app levels, (-1, -1) if the map has none
+	glm::ivec2 ivSpawnPos = glm::ivec2(-1), ivFinishPos = glm::ivec2(-1);
+
+	bool IsWalkable(int iX, int iY) const
+	{
+		return iX >= 0 && iY >= 0 && iX < iWidth && iY < iHeight && vecWalkable[iY * iWidth + iX];
+	}
+
+	//the assets/tilemap*.csv levels of the app, -1 blank, 0 wall, 1 path, 2 stairs and 3 spawn
+	bool LoadTilemap(const std::string& strPath)
+	{
+		std::ifstream fileTilemap(strPath);
+		if (!fileTilemap.is_open())
+			return false;
+
+		std::vector<std::vector<int>> vecRows;
+		std::string strLine;
+		while (std::getline(fileTilemap, strLine))
+		{
+			std::vector<int> vecRow;
+			std::stringstream ssLine(strLine);
+			std::string strTile;
+			while (std::getline(ssLine, strTile, ','))
+				vecRow.push_back(strTile.empty() ? -1 : std::atoi(strTile.c_str()));
+			vecRows.push_back(vecRow);
+		}
+
+		iWidth = 0;
+		iHeight = static_cast<int>(vecRows.size());
+		for (auto& vecRow : vecRows)
+			iWidth = glm::max(iWidth, static_cast<int>(vecRow.size()));
+		vecWalkable.assign(static_cast<std::size_t>(iWidth) * iHeight, 0);
+		for (int iY = 0; iY < iHeight; iY++)
+		{
+			for (int iX = 0; iX < static_cast<int>(vecRows[iY].size()); iX++)
+			{
+				int iTile = vecRows[iY][iX];
+				vecWalkable[iY * iWidth + iX] = iTile == 1 || iTile == 2 || iTile == 3;
+				if (iTile == 2)
+					ivFinishPos = glm::ivec2(iX, iY);
+				else if (iTile == 3)
+					ivSpawnPos = glm::ivec2(iX, iY);
+			}
+		}
+		return true;
+	}
+
+	//MovingAI benchmark maps, a "type octile" header with height and width and then one character per tile
+	//. G and S are passable, everything else (@ O T W) is treated as an obstacle
+	bool LoadMovingAI(const std::string& strPath)
+	{
+		std::ifstream fileMap(strPath);
+		if (!fileMap.is_open())
+			return false;
+
+		std::string strKey;
+		iWidth = iHeight = 0;
+		while (fileMap >> strKey && strKey != "map")
+		{
+			if (strKey == "height")
+				fileMap >> iHeight;
+			else if (strKey == "width")
+				fileMap >> iWidth;
+			else
+				fileMap >> strKey;
+		}
+		if (strKey != "map" || iWidth <= 0 || iHeight <= 0)
+			return false;
+
+		vecWalkable.assign(static_cast<std::size_t>(iWidth) * iHeight, 0);
+		std::string strLine;
+		std::getline(fileMap, strLine);
+		for (int iY = 0; iY < iHeight && std::getline(fileMap, strLine); iY++)
+			for (int iX = 0; iX < iWidth && iX < static_cast<int>(strLine.size()); iX++)
+				vecWalkable[iY * iWidth + iX] = strLine[iX] == '.' || strLine[iX] == 'G' || strLine[iX] == 'S';
+		return true;
+	}
+
+	//scattered walls and a few runs of wall with gaps in them, so there are rooms, corridors and dead ends to search
+	//around, mt19937 is the same everywhere so the same arguments give the same level on every platform
+	void Generate(int iWidth, int iHeight, int iWallPercent, std::uint32_t iSeed)
+	{
+		this->iWidth = iWidth;
+		this->iHeight = iHeight;
+		ivSpawnPos = ivFinishPos = glm::ivec2(-1);
+		vecWalkable.assign(static_cast<std::size_t>(iWidth) * iHeight, 1);
+		std::mt19937 rng(iSeed);
+		for (auto& iWalkable : vecWalkable)
+			iWalkable = static_cast<int>(rng() % 100) >= iWallPercent;
+		for (int iRun = 0; iRun < (iWidth + iHeight) / 8; iRun++)
+		{
+			bool bHorizontal = rng() % 2 == 0;
+			int iX = rng() % iWidth, iY = rng() % iHeight, iLength = 4 + rng() % (glm::max(iWidth, iHeight) / 2);
+			for (int i = 0; i < iLength && iX < iWidth && iY < iHeight; i++)
+			{
+				vecWalkable[iY * iWidth + iX] = rng() % 8 == 0;
+				(bHorizontal ? iX : iY)++;
+			}
+		}
+	}
+
+	//picks the loader by extension, .map is MovingAI and anything else a tilemap csv
+	//random:WIDTHxHEIGHT:WALLPERCENT[:SEED] is no file but a level from Generate, so benchmarks can be run on large
+	//levels without shipping them
+	bool Load(const std::string& strPath)
+	{
+		if (strPath.compare(0, 7, "random:") == 0)
+		{
+			int iGeneratedWidth = 0, iGeneratedHeight = 0, iWallPercent = 0;
+			unsigned int iSeed = 1;
+			if (std::sscanf(strPath.c_str() + 7, "%dx%d:%d:%u", &iGeneratedWidth, &iGeneratedHeight, &iWallPercent, &iSeed) < 3 ||
+				iGeneratedWidth <= 0 || iGeneratedHeight <= 0)
+				return false;
+			Generate(iGeneratedWidth, iGeneratedHeight, iWallPercent, iSeed);
+			return true;
+		}
+		if (strPath.size() > 4 && strPath.compare(strPath.size() - 4, 4, ".map") == 0)
+			return LoadMovingAI(strPath);
+		return LoadTilemap(strPath);
+	}
+
+	//inserts every walkable cell and builds the grid
+	void Apply(Pathfinder& pathfinder) const
+	{
+		for (int iY = 0; iY < iHeight; iY++)
+			for (int iX = 0; iX < iWidth; iX++)
+				if (vecWalkable[iY * iWidth + iX])
+					pathfinder.InsertNode(glm::ivec2(iX, iY));
+		pathfinder.BuildGrid(iWidth, iHeight);
+	}
+};
@@ -0,0 +1,533 @@
+//hierarchical pathfinding (HPA*) abstraction of a PathfindingGrid
+//the grid is split into fixed size clusters, the cells where two clusters touch become entrance nodes and
+//the cost between the entrances of a cluster is precomputed, so long queries only search this small graph
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+
+class HierarchicalGraph
+{
+public:
+	struct Edge
+	{
+		int iNode;
+		float fCost;
+	};
+
+	struct Node
+	{
+		int iCell;
+		int iCluster;
+		std::vector<Edge> vecEdges;
+	};
+
+	typedef std::pair<float, int> QueueEntry;
+
+	//everything a query writes to, kept outside the graph so several queries can run on it at the same time
+	//and reused by the next query so it doesnt allocate once the buffers have grown
+	struct Scratch
+	{
+		//binary heap of both searches, smallest first with std::greater
+		std::vector<QueueEntry> vecQueue;
+		//searches inside a single cluster, indexed by the position inside the cluster
+		std::vector<float> vecLocalG;
+		std::vector<std::int32_t> vecLocalParent;
+		//the abstract search, two more than the graph has nodes for the start and target of the query
+		std::vector<float> vecAbstractG;
+		std::vector<std::int32_t> vecAbstractParent;
+		std::vector<std::uint8_t> vecAbstractClosed;
+		//edges of the temporary start node and the cost from every entrance to the target, -1 if it cant reach it
+		std::vector<Edge> vecStartEdges, vecTargetEdges;
+		std::vector<float> vecTargetCosts;
+	};
+
+private:
+	int iClusterSize, iClustersX, iClustersY;
+	std::vector<Node> vecNodes;
+	//cell -> entrance node on it
+	std::unordered_map<int, int> mapCellNodes;
+	//entrance nodes of every cluster
+	std::vector<std::vector<int>> vecClusterNodes;
+	//nodes dropped by TileChanged, their iCell is -1 and AddNode reuses them
+	std::vector<int> vecFreeNodes;
+
+	static void PushQueue(std::vector<QueueEntry>& vecQueue, const QueueEntry& entry)
+	{
+		vecQueue.push_back(entry);
+		std::push_heap(vecQueue.begin(), vecQueue.end(), std::greater<QueueEntry>());
+	}
+
+	static QueueEntry PopQueue(std::vector<QueueEntry>& vecQueue)
+	{
+		std::pop_heap(vecQueue.begin(), vecQueue.end(), std::greater<QueueEntry>());
+		QueueEntry entry = vecQueue.back();
+		vecQueue.pop_back();
+		return entry;
+	}
+
+	static float Octile(const glm::ivec2& a, const glm::ivec2& b)
+	{
+		float absX = static_cast<float>(glm::abs(a.x - b.x)), absY = static_cast<float>(glm::abs(a.y - b.y));
+		return (absX + absY) + (1.414f - 2.0f) * glm::min(absX, absY);
+	}
+
+	//top left corner and size of a cluster, the ones on the right and bottom edge can be smaller
+	glm::ivec4 ClusterRect(const PathfindingGrid& grid, int iCluster) const
+	{
+		int iX = (iCluster % iClustersX) * iClusterSize, iY = (iCluster / iClustersX) * iClusterSize;
+		return glm::ivec4(iX, iY, glm::min(iClusterSize, grid.Width() - iX), glm::min(iClusterSize, grid.Height() - iY));
+	}
+
+	int AddNode(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		int iCell = grid.Index(ivGridPos);
+		auto it = mapCellNodes.find(iCell);
+		if (it != mapCellNodes.end())
+			return it->second;
+
+		int iCluster = Cluster(ivGridPos);
+		int iNode;
+		if (vecFreeNodes.empty())
+		{
+			iNode = static_cast<int>(vecNodes.size());
+			vecNodes.push_back(Node{ iCell, iCluster, {} });
+		}
+		else
+		{
+			iNode = vecFreeNodes.back();
+			vecFreeNodes.pop_back();
+			vecNodes[iNode].iCell = iCell;
+			vecNodes[iNode].iCluster = iCluster;
+		}
+		mapCellNodes[iCell] = iNode;
+		vecClusterNodes[iCluster].push_back(iNode);
+		return iNode;
+	}
+
+	void AddTransition(const PathfindingGrid& grid, const glm::ivec2& a, const glm::ivec2& b)
+	{
+		int iNodeA = AddNode(grid, a), iNodeB = AddNode(grid, b);
+		float fCost = (a.x != b.x && a.y != b.y) ? 1.414f : 1.0f;
+		vecNodes[iNodeA].vecEdges.push_back(Edge{ iNodeB, fCost });
+		vecNodes[iNodeB].vecEdges.push_back(Edge{ iNodeA, fCost });
+	}
+
+	//the node stays in vecNodes so the indices of the others dont change, it can only still have edges inside its
+	//cluster and those are dropped on both ends before AddNode can give the index to another cell
+	void RemoveNode(int iNode)
+	{
+		Node& node = vecNodes[iNode];
+		mapCellNodes.erase(node.iCell);
+		std::vector<int>& vecNodesInCluster = vecClusterNodes[node.iCluster];
+		vecNodesInCluster.erase(std::find(vecNodesInCluster.begin(), vecNodesInCluster.end(), iNode));
+		for (int iOther : vecNodesInCluster)
+		{
+			std::vector<Edge>& vecOtherEdges = vecNodes[iOther].vecEdges;
+			vecOtherEdges.erase(std::remove_if(vecOtherEdges.begin(), vecOtherEdges.end(), [iNode](const Edge& edge) { return edge.iNode == iNode; }), vecOtherEdges.end());
+		}
+		node.iCell = -1;
+		node.vecEdges.clear();
+		vecFreeNodes.push_back(iNode);
+	}
+
+	//clusters meeting only at a corner, a is the corner cell of one and b the one diagonally across from it
+	void AddCorner(const PathfindingGrid& grid, const glm::ivec2& a, const glm::ivec2& b)
+	{
+		if (grid.IsWalkable(a) && grid.IsWalkable(b))
+			AddTransition(grid, a, b);
+	}
+
+	//entrances along the border between two neighbouring clusters
+	//ivSideA + i * ivAlong and ivSideB + i * ivAlong are the two cells facing each other across the border
+	void AddEntrances(const PathfindingGrid& grid, glm::ivec2 ivSideA, glm::ivec2 ivSideB, glm::ivec2 ivAlong, int iLength)
+	{
+		auto bCrossing = [&](int i) { return i >= 0 && i < iLength && grid.IsWalkable(ivSideA + i * ivAlong) && grid.IsWalkable(ivSideB + i * ivAlong); };
+
+		//every run of cells open on both sides gets one transition in its middle, long runs one at each end
+		int iRunStart = -1;
+		for (int i = 0; i <= iLength; i++)
+		{
+			if (bCrossing(i))
+			{
+				if (iRunStart == -1)
+					iRunStart = i;
+				continue;
+			}
+			if (iRunStart != -1)
+			{
+				int iRunEnd = i - 1;
+				if (iRunEnd - iRunStart + 1 < 6)
+				{
+					int iMiddle = (iRunStart + iRunEnd) / 2;
+					AddTransition(grid, ivSideA + iMiddle * ivAlong, ivSideB + iMiddle * ivAlong);
+				}
+				else
+				{
+					AddTransition(grid, ivSideA + iRunStart * ivAlong, ivSideB + iRunStart * ivAlong);
+					AddTransition(grid, ivSideA + iRunEnd * ivAlong, ivSideB + iRunEnd * ivAlong);
+				}
+				iRunStart = -1;
+			}
+		}
+
+		//diagonal moves are allowed past corners so two clusters can also touch only diagonally,
+		//those get their own transition unless a straight crossing right next to them already connects both sides
+		for (int i = 0; i + 1 < iLength; i++)
+		{
+			if (bCrossing(i) || bCrossing(i + 1))
+				continue;
+			if (grid.IsWalkable(ivSideA + i * ivAlong) && grid.IsWalkable(ivSideB + (i + 1) * ivAlong))
+				AddTransition(grid, ivSideA + i * ivAlong, ivSideB + (i + 1) * ivAlong);
+			if (grid.IsWalkable(ivSideA + (i + 1) * ivAlong) && grid.IsWalkable(ivSideB + i * ivAlong))
+				AddTransition(grid, ivSideA + (i + 1) * ivAlong, ivSideB + i * ivAlong);
+		}
+	}
+
+	//dijkstra from ivStartPos that never leaves the cluster, stops early once ivTargetPos is closed
+	//results are in the scratch vecLocalG / vecLocalParent indexed by the position inside the cluster rect
+	static void ClusterSearch(const PathfindingGrid& grid, const glm::ivec4& ivRect, const glm::ivec2& ivStartPos, const glm::ivec2* ivTargetPos, Scratch& scratch)
+	{
+		std::vector<float>& vecLocalG = scratch.vecLocalG;
+		std::vector<std::int32_t>& vecLocalParent = scratch.vecLocalParent;
+		int iSize = ivRect.z * ivRect.w;
+		vecLocalG.assign(iSize, -1.0f);
+		vecLocalParent.assign(iSize, -1);
+		auto Local = [&](int iX, int iY) { return (iY - ivRect.y) * ivRect.z + (iX - ivRect.x); };
+
+		std::vector<QueueEntry>& vecQueue = scratch.vecQueue;
+		vecQueue.clear();
+		vecLocalG[Local(ivStartPos.x, ivStartPos.y)] = 0.0f;
+		PushQueue(vecQueue, QueueEntry(0.0f, Local(ivStartPos.x, ivStartPos.y)));
+		while (!vecQueue.empty())
+		{
+			QueueEntry entry = PopQueue(vecQueue);
+			if (entry.first > vecLocalG[entry.second])
+				continue;
+			int iX = ivRect.x + entry.second % ivRect.z, iY = ivRect.y + entry.second / ivRect.z;
+			if (ivTargetPos && iX == ivTargetPos->x && iY == ivTargetPos->y)
+				return;
+
+			for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+			{
+				int iNextX = iX + GridDirection::iX[iDir], iNextY = iY + GridDirection::iY[iDir];
+				if (iNextX < ivRect.x || iNextY < ivRect.y || iNextX >= ivRect.x + ivRect.z || iNextY >= ivRect.y + ivRect.w)
+					continue;
+				if (!grid.IsWalkable(iNextX, iNextY))
+					continue;
+				int iNext = Local(iNextX, iNextY);
+				float G = entry.first + (GridDirection::IsDiagonal(iDir) ? 1.414f : 1.0f);
+				if (vecLocalG[iNext] < 0.0f || G < vecLocalG[iNext])
+				{
+					vecLocalG[iNext] = G;
+					vecLocalParent[iNext] = entry.second;
+					PushQueue(vecQueue, QueueEntry(G, iNext));
+				}
+			}
+		}
+	}
+
+	//costs from a cell to every entrance of its cluster it can reach without leaving the cluster
+	void ClusterEdges(const PathfindingGrid& grid, const glm::ivec2& ivGridPos, std::vector<Edge>& vecEdges, Scratch& scratch) const
+	{
+		vecEdges.clear();
+		int iCluster = Cluster(ivGridPos);
+		glm::ivec4 ivRect = ClusterRect(grid, iCluster);
+		ClusterSearch(grid, ivRect, ivGridPos, nullptr, scratch);
+		for (int iNode : vecClusterNodes[iCluster])
+		{
+			glm::ivec2 ivNodePos = grid.Position(vecNodes[iNode].iCell);
+			float G = scratch.vecLocalG[(ivNodePos.y - ivRect.y) * ivRect.z + (ivNodePos.x - ivRect.x)];
+			if (G >= 0.0f)
+				vecEdges.push_back(Edge{ iNode, G });
+		}
+	}
+
+	//intra cluster edges between every pair of entrances of the cluster that can reach each other inside it, the ones
+	//it had are dropped first
+	void ConnectCluster(const PathfindingGrid& grid, int iCluster, std::vector<Edge>& vecEdges, Scratch& scratch)
+	{
+		for (int iNode : vecClusterNodes[iCluster])
+		{
+			std::vector<Edge>& vecNodeEdges = vecNodes[iNode].vecEdges;
+			vecNodeEdges.erase(std::remove_if(vecNodeEdges.begin(), vecNodeEdges.end(), [this, iCluster](const Edge& edge) { return vecNodes[edge.iNode].iCluster == iCluster; }),
+				vecNodeEdges.end());
+		}
+		for (int iNode : vecClusterNodes[iCluster])
+		{
+			ClusterEdges(grid, grid.Position(vecNodes[iNode].iCell), vecEdges, scratch);
+			for (auto& edge : vecEdges)
+				if (edge.iNode != iNode)
+					vecNodes[iNode].vecEdges.push_back(edge);
+		}
+	}
+
+	//ConnectCluster for a cluster whose cells didnt change but that got the entrances from iFirst on in vecClusterNodes,
+	//only those are searched from and the others get the same cost back to them, the grid is undirected
+	void ConnectNewNodes(const PathfindingGrid& grid, int iCluster, std::size_t iFirst, std::vector<Edge>& vecEdges, Scratch& scratch)
+	{
+		const std::vector<int>& vecNodesInCluster = vecClusterNodes[iCluster];
+		for (std::size_t iIndex = iFirst; iIndex < vecNodesInCluster.size(); iIndex++)
+		{
+			int iNode = vecNodesInCluster[iIndex];
+			ClusterEdges(grid, grid.Position(vecNodes[iNode].iCell), vecEdges, scratch);
+			for (auto& edge : vecEdges)
+			{
+				if (edge.iNode == iNode)
+					continue;
+				vecNodes[iNode].vecEdges.push_back(edge);
+				if (std::find(vecNodesInCluster.begin() + iFirst, vecNodesInCluster.end(), edge.iNode) == vecNodesInCluster.end())
+					vecNodes[edge.iNode].vecEdges.push_back(Edge{ iNode, edge.fCost });
+			}
+		}
+	}
+
+public:
+	HierarchicalGraph() : iClusterSize(16), iClustersX(0), iClustersY(0) {}
+
+	bool Empty() const { return iClustersX == 0; }
+	std::size_t NodeCount() const { return vecNodes.size() - vecFreeNodes.size(); }
+	int ClusterSize() const { return iClusterSize; }
+	//the entrance node on a cell, -1 if there is none
+	int NodeAt(int iCell) const
+	{
+		auto it = mapCellNodes.find(iCell);
+		return it != mapCellNodes.end() ? it->second : -1;
+	}
+	const Node& GetNode(int iNode) const { return vecNodes[iNode]; }
+
+	int Cluster(const glm::ivec2& ivGridPos) const
+	{
+		return (ivGridPos.y / iClusterSize) * iClustersX + (ivGridPos.x / iClusterSize);
+	}
+
+	void Clear()
+	{
+		iClustersX = iClustersY = 0;
+		vecNodes.clear();
+		mapCellNodes.clear();
+		vecClusterNodes.clear();
+		vecFreeNodes.clear();
+	}
+
+	void Build(const PathfindingGrid& grid, int iClusterSize)
+	{
+		Clear();
+		this->iClusterSize = iClusterSize;
+		iClustersX = (grid.Width() + iClusterSize - 1) / iClusterSize;
+		iClustersY = (grid.Height() + iClusterSize - 1) / iClusterSize;
+		vecClusterNodes.resize(static_cast<std::size_t>(iClustersX) * iClustersY);
+
+		for (int iCY = 0; iCY < iClustersY; iCY++)
+		{
+			for (int iCX = 0; iCX < iClustersX; iCX++)
+			{
+				glm::ivec4 ivRect = ClusterRect(grid, iCY * iClustersX + iCX);
+				int iRight = ivRect.x + ivRect.z, iBottom = ivRect.y + ivRect.w;
+				//border with the cluster on the right and the one below
+				if (iCX + 1 < iClustersX)
+					AddEntrances(grid, glm::ivec2(iRight - 1, ivRect.y), glm::ivec2(iRight, ivRect.y), glm::ivec2(0, 1), ivRect.w);
+				if (iCY + 1 < iClustersY)
+					AddEntrances(grid, glm::ivec2(ivRect.x, iBottom - 1), glm::ivec2(ivRect.x, iBottom), glm::ivec2(1, 0), ivRect.z);
+				//clusters meeting only at a corner
+				if (iCX + 1 < iClustersX && iCY + 1 < iClustersY)
+				{
+					AddCorner(grid, glm::ivec2(iRight - 1, iBottom - 1), glm::ivec2(iRight, iBottom));
+					AddCorner(grid, glm::ivec2(iRight, iBottom - 1), glm::ivec2(iRight - 1, iBottom));
+				}
+			}
+		}
+
+		std::vector<Edge> vecEdges;
+		Scratch scratch;
+		for (int iCluster = 0; iCluster < static_cast<int>(vecClusterNodes.size()); iCluster++)
+			ConnectCluster(grid, iCluster, vecEdges, scratch);
+	}
+
+	//a tile of the grid changed, only the clusters that can see it are built again
+	//a tile inside a cluster only changes the paths between its entrances, a tile on its edge can also change the
+	//entrances on its borders, every transition out of the cluster is dropped with the entrances that were only there
+	//for one and the borders are scanned again, the clusters around it only get paths for their new entrances
+	void TileChanged(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		std::vector<Edge> vecEdges;
+		Scratch scratch;
+		int iCluster = Cluster(ivGridPos);
+		glm::ivec4 ivRect = ClusterRect(grid, iCluster);
+		int iRight = ivRect.x + ivRect.z, iBottom = ivRect.y + ivRect.w;
+		if (ivGridPos.x != ivRect.x && ivGridPos.y != ivRect.y && ivGridPos.x != iRight - 1 && ivGridPos.y != iBottom - 1)
+		{
+			ConnectCluster(grid, iCluster, vecEdges, scratch);
+			return;
+		}
+
+		std::vector<int> vecNodesInCluster = vecClusterNodes[iCluster], vecOutside;
+		for (int iNode : vecNodesInCluster)
+			for (auto& edge : vecNodes[iNode].vecEdges)
+			{
+				Node& other = vecNodes[edge.iNode];
+				if (other.iCluster == iCluster)
+					continue;
+				other.vecEdges.erase(std::remove_if(other.vecEdges.begin(), other.vecEdges.end(), [iNode](const Edge& otherEdge) { return otherEdge.iNode == iNode; }),
+					other.vecEdges.end());
+				vecOutside.push_back(edge.iNode);
+			}
+		for (int iNode : vecNodesInCluster)
+			RemoveNode(iNode);
+		for (int iNode : vecOutside)
+		{
+			if (vecNodes[iNode].iCell < 0)
+				continue;
+			const std::vector<Edge>& vecNodeEdges = vecNodes[iNode].vecEdges;
+			int iNodeCluster = vecNodes[iNode].iCluster;
+			if (std::none_of(vecNodeEdges.begin(), vecNodeEdges.end(), [this, iNodeCluster](const Edge& edge) { return vecNodes[edge.iNode].iCluster != iNodeCluster; }))
+				RemoveNode(iNode);
+		}
+
+		//what the clusters around it still have, the entrances they get are added after
+		int iCX = iCluster % iClustersX, iCY = iCluster / iClustersX;
+		int iMinX = glm::max(iCX - 1, 0), iMaxX = glm::min(iCX + 1, iClustersX - 1), iMinY = glm::max(iCY - 1, 0), iMaxY = glm::min(iCY + 1, iClustersY - 1);
+		std::size_t iKept[9];
+		for (int iY = iMinY; iY <= iMaxY; iY++)
+			for (int iX = iMinX; iX <= iMaxX; iX++)
+				iKept[(iY - iCY + 1) * 3 + (iX - iCX + 1)] = vecClusterNodes[iY * iClustersX + iX].size();
+
+		if (iCX + 1 < iClustersX)
+			AddEntrances(grid, glm::ivec2(iRight - 1, ivRect.y), glm::ivec2(iRight, ivRect.y), glm::ivec2(0, 1), ivRect.w);
+		if (iCX > 0)
+			AddEntrances(grid, glm::ivec2(ivRect.x - 1, ivRect.y), glm::ivec2(ivRect.x, ivRect.y), glm::ivec2(0, 1), ivRect.w);
+		if (iCY + 1 < iClustersY)
+			AddEntrances(grid, glm::ivec2(ivRect.x, iBottom - 1), glm::ivec2(ivRect.x, iBottom), glm::ivec2(1, 0), ivRect.z);
+		if (iCY > 0)
+			AddEntrances(grid, glm::ivec2(ivRect.x, ivRect.y - 1), glm::ivec2(ivRect.x, ivRect.y), glm::ivec2(1, 0), ivRect.z);
+		//the corner transitions between the two clusters diagonal to each other that arent this one stay as they are
+		if (iCX + 1 < iClustersX && iCY + 1 < iClustersY)
+			AddCorner(grid, glm::ivec2(iRight - 1, iBottom - 1), glm::ivec2(iRight, iBottom));
+		if (iCX > 0 && iCY + 1 < iClustersY)
+			AddCorner(grid, glm::ivec2(ivRect.x, iBottom - 1), glm::ivec2(ivRect.x - 1, iBottom));
+		if (iCX + 1 < iClustersX && iCY > 0)
+			AddCorner(grid, glm::ivec2(iRight - 1, ivRect.y), glm::ivec2(iRight, ivRect.y - 1));
+		if (iCX > 0 && iCY > 0)
+			AddCorner(grid, glm::ivec2(ivRect.x, ivRect.y), glm::ivec2(ivRect.x - 1, ivRect.y - 1));
+
+		ConnectCluster(grid, iCluster, vecEdges, scratch);
+		for (int iY = iMinY; iY <= iMaxY; iY++)
+			for (int iX = iMinX; iX <= iMaxX; iX++)
+				if (iY * iClustersX + iX != iCluster)
+					ConnectNewNodes(grid, iY * iClustersX + iX, iKept[(iY - iCY + 1) * 3 + (iX - iCX + 1)], vecEdges, scratch);
+	}
+
+	//searches the abstract graph, on success vecWaypoints holds the cells from ivStartPos to ivTargetPos
+	//every two consecutive waypoints are either in the same cluster or neighbours across a border
+	bool FindPath(const PathfindingGrid& grid, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos, std::vector<glm::ivec2>& vecWaypoints, Scratch& scratch) const
+	{
+		vecWaypoints.clear();
+		//start and target are inserted as two temporary nodes after the real ones
+		int iStartNode = static_cast<int>(vecNodes.size()), iTargetNode = iStartNode + 1;
+		std::vector<Edge>& vecStartEdges = scratch.vecStartEdges;
+		std::vector<Edge>& vecTargetEdges = scratch.vecTargetEdges;
+		ClusterEdges(grid, ivStartPos, vecStartEdges, scratch);
+		ClusterEdges(grid, ivTargetPos, vecTargetEdges, scratch);
+		//start and target in the same cluster can also be connected directly
+		if (Cluster(ivStartPos) == Cluster(ivTargetPos))
+		{
+			glm::ivec4 ivRect = ClusterRect(grid, Cluster(ivStartPos));
+			ClusterSearch(grid, ivRect, ivStartPos, &ivTargetPos, scratch);
+			float G = scratch.vecLocalG[(ivTargetPos.y - ivRect.y) * ivRect.z + (ivTargetPos.x - ivRect.x)];
+			if (G >= 0.0f)
+				vecStartEdges.push_back(Edge{ iTargetNode, G });
+		}
+		std::vector<float>& vecTargetCosts = scratch.vecTargetCosts;
+		vecTargetCosts.assign(vecNodes.size() + 2, -1.0f);
+		for (auto& edge : vecTargetEdges)
+			vecTargetCosts[edge.iNode] = edge.fCost;
+
+		std::vector<float>& vecAbstractG = scratch.vecAbstractG;
+		std::vector<std::int32_t>& vecAbstractParent = scratch.vecAbstractParent;
+		std::vector<std::uint8_t>& vecAbstractClosed = scratch.vecAbstractClosed;
+		vecAbstractG.assign(vecNodes.size() + 2, -1.0f);
+		vecAbstractParent.assign(vecNodes.size() + 2, -1);
+		vecAbstractClosed.assign(vecNodes.size() + 2, 0);
+		auto Position = [&](int iNode) { return iNode == iStartNode ? ivStartPos : iNode == iTargetNode ? ivTargetPos : grid.Position(vecNodes[iNode].iCell); };
+
+		std::vector<QueueEntry>& vecQueue = scratch.vecQueue;
+		vecQueue.clear();
+		vecAbstractG[iStartNode] = 0.0f;
+		PushQueue(vecQueue, QueueEntry(Octile(ivStartPos, ivTargetPos), iStartNode));
+		while (!vecQueue.empty())
+		{
+			int iNode = PopQueue(vecQueue).second;
+			//the queue can hold older more expensive copies of a node
+			if (vecAbstractClosed[iNode])
+				continue;
+			vecAbstractClosed[iNode] = 1;
+			float G = vecAbstractG[iNode];
+
+			if (iNode == iTargetNode)
+			{
+				for (; iNode != -1; iNode = vecAbstractParent[iNode])
+					vecWaypoints.push_back(Position(iNode));
+				std::reverse(vecWaypoints.begin(), vecWaypoints.end());
+				return true;
+			}
+
+			auto Relax = [&](int iNext, float fCost)
+			{
+				float nextG = G + fCost;
+				if (!vecAbstractClosed[iNext] && (vecAbstractG[iNext] < 0.0f || nextG < vecAbstractG[iNext]))
+				{
+					vecAbstractG[iNext] = nextG;
+					vecAbstractParent[iNext] = iNode;
+					PushQueue(vecQueue, QueueEntry(nextG + Octile(Position(iNext), ivTargetPos), iNext));
+				}
+			};
+			const std::vector<Edge>& vecEdges = iNode == iStartNode ? vecStartEdges : vecNodes[iNode].vecEdges;
+			for (auto& edge : vecEdges)
+				Relax(edge.iNode, edge.fCost);
+			if (vecTargetCosts[iNode] >= 0.0f)
+				Relax(iTargetNode, vecTargetCosts[iNode]);
+		}
+		return false;
+	}
+
+	//turns two consecutive waypoints back into tiles, appends every tile after ivFromPos up to and including ivToPos
+	bool Refine(const PathfindingGrid& grid, const glm::ivec2& ivFromPos, const glm::ivec2& ivToPos, std::vector<glm::ivec2>& vecTiles, Scratch& scratch) const
+	{
+		if (ivFromPos == ivToPos)
+			return true;
+		//waypoints in different clusters are always neighbours across the border
+		if (Cluster(ivFromPos) != Cluster(ivToPos))
+		{
+			vecTiles.push_back(ivToPos);
+			return true;
+		}
+
+		glm::ivec4 ivRect = ClusterRect(grid, Cluster(ivFromPos));
+		ClusterSearch(grid, ivRect, ivFromPos, &ivToPos, scratch);
+		int iLocal = (ivToPos.y - ivRect.y) * ivRect.z + (ivToPos.x - ivRect.x);
+		if (scratch.vecLocalG[iLocal] < 0.0f)
+			return false;
+
+		std::size_t iFirst = vecTiles.size();
+		int iStartLocal = (ivFromPos.y - ivRect.y) * ivRect.z + (ivFromPos.x - ivRect.x);
+		for (; iLocal != iStartLocal; iLocal = scratch.vecLocalParent[iLocal])
+			vecTiles.push_back(glm::ivec2(ivRect.x + iLocal % ivRect.z, ivRect.y + iLocal / ivRect.z));
+		std::reverse(vecTiles.begin() + iFirst, vecTiles.end());
+		return true;
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		std::size_t iBytes = vecNodes.size() * sizeof(Node) + mapCellNodes.size() * (sizeof(int) * 2 + sizeof(void*) * 2);
+		for (auto& node : vecNodes)
+			iBytes += node.vecEdges.size() * sizeof(Edge);
+		for (auto& vecNodesInCluster : vecClusterNodes)
+			iBytes += vecNodesInCluster.size() * sizeof(int);
+		return iBytes;
+	}
+};
@@ -0,0 +1,262 @@
+//jump point search on a uniform cost 8 connected PathfindingGrid
+//diagonal moves are allowed past corners, same as the plain a* neighbors, so both find paths of the same cost
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+
+namespace JumpPointSearch
+{
+	//walks from (iX, iY) in the direction (iDX, iDY) until it reaches a jump point, the target or an obstacle
+	//returns the cell of the jump point / target or -1 if the walk ran into an obstacle
+	inline int Jump(const PathfindingGrid& grid, int iX, int iY, int iDX, int iDY, const glm::ivec2& ivTargetPos)
+	{
+		while (true)
+		{
+			iX += iDX;
+			iY += iDY;
+			if (!grid.IsWalkable(iX, iY))
+				return -1;
+			if (iX == ivTargetPos.x && iY == ivTargetPos.y)
+				return grid.Index(iX, iY);
+
+			if (iDX != 0 && iDY != 0)
+			{
+				//forced neighbors while moving diagonally
+				if ((grid.IsWalkable(iX - iDX, iY + iDY) && !grid.IsWalkable(iX - iDX, iY)) ||
+					(grid.IsWalkable(iX + iDX, iY - iDY) && !grid.IsWalkable(iX, iY - iDY)))
+					return grid.Index(iX, iY);
+				//a diagonal node is also a jump point if a straight jump from it finds one
+				if (Jump(grid, iX, iY, iDX, 0, ivTargetPos) != -1 || Jump(grid, iX, iY, 0, iDY, ivTargetPos) != -1)
+					return grid.Index(iX, iY);
+			}
+			else if (iDX != 0)
+			{
+				if ((grid.IsWalkable(iX + iDX, iY + 1) && !grid.IsWalkable(iX, iY + 1)) ||
+					(grid.IsWalkable(iX + iDX, iY - 1) && !grid.IsWalkable(iX, iY - 1)))
+					return grid.Index(iX, iY);
+			}
+			else
+			{
+				if ((grid.IsWalkable(iX + 1, iY + iDY) && !grid.IsWalkable(iX + 1, iY)) ||
+					(grid.IsWalkable(iX - 1, iY + iDY) && !grid.IsWalkable(iX - 1, iY)))
+					return grid.Index(iX, iY);
+			}
+		}
+	}
+
+	//directions worth jumping in from a node that was reached moving in (iDX, iDY)
+	//the natural neighbors plus the forced ones, (0, 0) means the start node and gives all 8 directions
+	//fills ivDirs and returns how many there are, at most 8
+	inline int PrunedDirections(const PathfindingGrid& grid, const glm::ivec2& ivPos, int iDX, int iDY, glm::ivec2* ivDirs)
+	{
+		int iCount = 0;
+		int iX = ivPos.x, iY = ivPos.y;
+		if (iDX == 0 && iDY == 0)
+		{
+			for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+				ivDirs[iCount++] = glm::ivec2(GridDirection::iX[iDir], GridDirection::iY[iDir]);
+		}
+		else if (iDX != 0 && iDY != 0)
+		{
+			ivDirs[iCount++] = glm::ivec2(0, iDY);
+			ivDirs[iCount++] = glm::ivec2(iDX, 0);
+			ivDirs[iCount++] = glm::ivec2(iDX, iDY);
+			if (!grid.IsWalkable(iX - iDX, iY))
+				ivDirs[iCount++] = glm::ivec2(-iDX, iDY);
+			if (!grid.IsWalkable(iX, iY - iDY))
+				ivDirs[iCount++] = glm::ivec2(iDX, -iDY);
+		}
+		else if (iDX != 0)
+		{
+			ivDirs[iCount++] = glm::ivec2(iDX, 0);
+			if (!grid.IsWalkable(iX, iY + 1))
+				ivDirs[iCount++] = glm::ivec2(iDX, 1);
+			if (!grid.IsWalkable(iX, iY - 1))
+				ivDirs[iCount++] = glm::ivec2(iDX, -1);
+		}
+		else
+		{
+			ivDirs[iCount++] = glm::ivec2(0, iDY);
+			if (!grid.IsWalkable(iX + 1, iY))
+				ivDirs[iCount++] = glm::ivec2(1, iDY);
+			if (!grid.IsWalkable(iX - 1, iY))
+				ivDirs[iCount++] = glm::ivec2(-1, iDY);
+		}
+		return iCount;
+	}
+};
+
+
+//JPS+, the distance to the next jump point or obstacle from every cell in all 8 directions precomputed once per level
+//so the online search never has to scan rows, the jumps become a table lookup
+//a positive distance is the number of steps to the next jump point, zero or negative is the number of walkable steps before an obstacle
+class JumpPointTable
+{
+	std::vector<std::int16_t> vecDistances[GridDirection::iCount];
+
+	static bool IsStraightJumpPoint(const PathfindingGrid& grid, int iX, int iY, int iDX, int iDY)
+	{
+		if (iDX != 0)
+			return (grid.IsWalkable(iX + iDX, iY + 1) && !grid.IsWalkable(iX, iY + 1)) ||
+				(grid.IsWalkable(iX + iDX, iY - 1) && !grid.IsWalkable(iX, iY - 1));
+		return (grid.IsWalkable(iX + 1, iY + iDY) && !grid.IsWalkable(iX + 1, iY)) ||
+			(grid.IsWalkable(iX - 1, iY + iDY) && !grid.IsWalkable(iX - 1, iY));
+	}
+
+	static bool IsDiagonalJumpPoint(const PathfindingGrid& grid, int iX, int iY, int iDX, int iDY)
+	{
+		return (grid.IsWalkable(iX - iDX, iY + iDY) && !grid.IsWalkable(iX - iDX, iY)) ||
+			(grid.IsWalkable(iX + iDX, iY - iDY) && !grid.IsWalkable(iX, iY - iDY));
+	}
+
+	//distance from a cell given the distance from the next cell along the same direction
+	//a run too long for int16 turns the next cell into a jump point, opening an extra node is harmless
+	static std::int16_t Extend(int iNextDistance)
+	{
+		int iDistance = iNextDistance > 0 ? iNextDistance + 1 : iNextDistance - 1;
+		if (iDistance > INT16_MAX || iDistance < -INT16_MAX)
+			return 1;
+		return static_cast<std::int16_t>(iDistance);
+	}
+
+	//the distance of a cell in iDir worked out from the cell after it, which has to be done already, and for the
+	//diagonals from the straight distances of that cell
+	std::int16_t CellDistance(const PathfindingGrid& grid, int iX, int iY, int iDir) const
+	{
+		int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+		int iNextX = iX + iDX, iNextY = iY + iDY;
+		if (!grid.IsWalkable(iNextX, iNextY))
+			return 0;
+		int iNextCell = grid.Index(iNextX, iNextY);
+		if (!GridDirection::IsDiagonal(iDir))
+			return IsStraightJumpPoint(grid, iNextX, iNextY, iDX, iDY) ? 1 : Extend(vecDistances[iDir][iNextCell]);
+		//a diagonal node is also a jump point if a straight jump from it finds one
+		bool bJumpPoint = IsDiagonalJumpPoint(grid, iNextX, iNextY, iDX, iDY) ||
+			vecDistances[GridDirection::FromDelta(iDX, 0)][iNextCell] > 0 ||
+			vecDistances[GridDirection::FromDelta(0, iDY)][iNextCell] > 0;
+		return bJumpPoint ? 1 : Extend(vecDistances[iDir][iNextCell]);
+	}
+
+	//scratch of TileChanged, the cells a walk starts from and the cells whose straight distances changed
+	std::vector<glm::ivec2> vecSeeds;
+	std::vector<int> vecChanged[GridDirection::iCount];
+
+public:
+	bool Empty() const { return vecDistances[0].empty(); }
+
+	void Clear()
+	{
+		for (auto& vecDistance : vecDistances)
+		{
+			vecDistance.clear();
+			vecDistance.shrink_to_fit();
+		}
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecDistances[0].size() * sizeof(std::int16_t) * GridDirection::iCount;
+	}
+
+	int Distance(int iCell, int iDir) const { return vecDistances[iDir][iCell]; }
+
+	void Build(const PathfindingGrid& grid)
+	{
+		int iWidth = grid.Width(), iHeight = grid.Height();
+		//straight directions first since the diagonal distances depend on them
+		for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			std::vector<std::int16_t>& vecDistance = vecDistances[iDir];
+			vecDistance.assign(grid.Size(), 0);
+
+			//walk against the direction so the next cell along it is always done before the current one
+			for (int j = 0; j < iHeight; j++)
+			{
+				int iY = iDY > 0 ? iHeight - 1 - j : j;
+				for (int i = 0; i < iWidth; i++)
+				{
+					int iX = iDX > 0 ? iWidth - 1 - i : i;
+					vecDistance[grid.Index(iX, iY)] = CellDistance(grid, iX, iY, iDir);
+				}
+			}
+		}
+	}
+
+	//a tile of the grid changed, only the distances that can see it are worked out again
+	//a distance reads the walkability within 2 cells of the cell and the distance of the next cell, so the cells around
+	//the tile are walked against every direction until a distance comes out the same as before, and the diagonals also
+	//from every cell whose straight distances changed, that is a few runs instead of the whole level
+	void TileChanged(const PathfindingGrid& grid, const glm::ivec2& ivGridPos)
+	{
+		for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			std::vector<std::int16_t>& vecDistance = vecDistances[iDir];
+			vecSeeds.clear();
+			for (int iY = ivGridPos.y - 2; iY <= ivGridPos.y + 2; iY++)
+				for (int iX = ivGridPos.x - 2; iX <= ivGridPos.x + 2; iX++)
+					vecSeeds.push_back(glm::ivec2(iX, iY));
+			if (GridDirection::IsDiagonal(iDir))
+			{
+				for (int iCell : vecChanged[GridDirection::FromDelta(iDX, 0)])
+					vecSeeds.push_back(grid.Position(iCell) - glm::ivec2(iDX, iDY));
+				for (int iCell : vecChanged[GridDirection::FromDelta(0, iDY)])
+					vecSeeds.push_back(grid.Position(iCell) - glm::ivec2(iDX, iDY));
+			}
+			//furthest along the direction first, the same order Build does them in
+			std::sort(vecSeeds.begin(), vecSeeds.end(), [iDX, iDY](const glm::ivec2& a, const glm::ivec2& b)
+				{
+					return a.x * iDX + a.y * iDY > b.x * iDX + b.y * iDY;
+				});
+
+			vecChanged[iDir].clear();
+			for (auto& ivSeedPos : vecSeeds)
+				for (glm::ivec2 ivPos = ivSeedPos; grid.InBounds(ivPos.x, ivPos.y); ivPos -= glm::ivec2(iDX, iDY))
+				{
+					int iCell = grid.Index(ivPos);
+					std::int16_t iDistance = CellDistance(grid, ivPos.x, ivPos.y, iDir);
+					if (iDistance == vecDistance[iCell])
+						break;
+					vecDistance[iCell] = iDistance;
+					vecChanged[iDir].push_back(iCell);
+				}
+		}
+	}
+
+	//same result as JumpPointSearch::Jump but read from the table
+	//the target is not in the table so it is checked here, for diagonals the node lined up with the target
+	//on its row or column becomes the jump point so the straight jump from it can reach the target
+	int Jump(const PathfindingGrid& grid, int iCell, int iDir, const glm::ivec2& ivTargetPos) const
+	{
+		int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+		int iDistance = vecDistances[iDir][iCell];
+		int iReach = glm::abs(iDistance);
+		glm::ivec2 ivPos = grid.Position(iCell);
+		int iTargetX = (ivTargetPos.x - ivPos.x) * iDX, iTargetY = (ivTargetPos.y - ivPos.y) * iDY;
+
+		if (iDX != 0 && iDY != 0)
+		{
+			if (iTargetX > 0 && iTargetY > 0)
+			{
+				int iSteps = glm::min(iTargetX, iTargetY);
+				if (iSteps <= iReach)
+					return grid.Index(ivPos.x + iSteps * iDX, ivPos.y + iSteps * iDY);
+			}
+		}
+		else if (iDX != 0)
+		{
+			if (ivTargetPos.y == ivPos.y && iTargetX > 0 && iTargetX <= iReach)
+				return grid.Index(ivTargetPos);
+		}
+		else if (ivTargetPos.x == ivPos.x && iTargetY > 0 && iTargetY <= iReach)
+			return grid.Index(ivTargetPos);
+
+		if (iDistance > 0)
+			return grid.Index(ivPos.x + iDistance * iDX, ivPos.y + iDistance * iDY);
+		return -1;
+	}
+};
@@ -0,0 +1,265 @@
+//ALT, lower bounds on the path cost from the triangle inequality over a few landmark cells
+//for any landmark L the cost from a to b is at least |d(L, a) - d(L, b)|, with the distances of every cell to every landmark
+//precomputed once per level that bound follows walls the octile estimate knows nothing about, on maze like levels
+//it is often the whole remaining cost
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+#include "SearchPolicy.h"
+
+//the distances are in the 10/14 units of COST_INTEGER on the steps the level policy allows, a bound in those units is a
+//bound for every cost type since the other diagonals are at least 1.4 straights, and it is consistent so the searches
+//never have to reopen a closed node
+//they are kept as uint16, interleaved per cell so the bounds of a cell are next to each other, a level whose distances
+//dont fit, paths of over 6500 straight steps, keeps them as uint32 instead, rounding them to fit would make the bounds
+//of neighbors differ by more than the step between them and the searches would close nodes too early
+class LandmarkTable
+{
+	int iWidth = 0, iLandmarks = 0;
+	//cell * iLandmarks + landmark, only one of them is filled
+	std::vector<std::uint16_t> vecDistances;
+	std::vector<std::uint32_t> vecWideDistances;
+	std::vector<glm::ivec2> vecLandmarks;
+
+	//the largest bound of the landmarks that reach both cells, the max of the type is a cell the landmark doesnt reach
+	template <class Distance>
+	std::int32_t Bound(const std::vector<Distance>& vecTable, int iCell, int iTargetCell) const
+	{
+		constexpr Distance iNone = std::numeric_limits<Distance>::max();
+		const Distance* pCell = &vecTable[static_cast<std::size_t>(iCell) * iLandmarks];
+		const Distance* pTarget = &vecTable[static_cast<std::size_t>(iTargetCell) * iLandmarks];
+		std::int32_t iBound = 0;
+		for (int iLandmark = 0; iLandmark < iLandmarks; iLandmark++)
+			if (pCell[iLandmark] != iNone && pTarget[iLandmark] != iNone)
+				iBound = glm::max(iBound, glm::abs(static_cast<std::int32_t>(pCell[iLandmark]) - static_cast<std::int32_t>(pTarget[iLandmark])));
+		return iBound;
+	}
+
+	template <class Distance>
+	static void Store(const std::vector<std::vector<std::int32_t>>& vecCosts, int iCells, std::vector<Distance>& vecTable)
+	{
+		std::size_t iCount = vecCosts.size();
+		vecTable.assign(static_cast<std::size_t>(iCells) * iCount, std::numeric_limits<Distance>::max());
+		for (std::size_t iLandmark = 0; iLandmark < iCount; iLandmark++)
+			for (int iCell = 0; iCell < iCells; iCell++)
+				if (vecCosts[iLandmark][iCell] != -1)
+					vecTable[static_cast<std::size_t>(iCell) * iCount + iLandmark] = static_cast<Distance>(vecCosts[iLandmark][iCell]);
+	}
+
+	//the steps the searches take from a cell with their cost, returns how many there are
+	static int Steps(const PathfindingGrid& grid, const SearchPolicy& policy, int iCell, int* arrCells, std::int32_t* arrCosts)
+	{
+		glm::ivec2 ivPos = grid.Position(iCell);
+		int iDirections = policy.mConnectivity == CONNECTIVITY_4 ? 4 : GridDirection::iCount;
+		int iCount = 0;
+		for (int iDir = 0; iDir < iDirections; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			if (!grid.IsWalkable(ivPos.x + iDX, ivPos.y + iDY))
+				continue;
+			bool bDiagonal = GridDirection::IsDiagonal(iDir);
+			if (bDiagonal && !policy.bCornerCutting && (!grid.IsWalkable(ivPos.x + iDX, ivPos.y) || !grid.IsWalkable(ivPos.x, ivPos.y + iDY)))
+				continue;
+			arrCells[iCount] = grid.Index(ivPos.x + iDX, ivPos.y + iDY);
+			arrCosts[iCount++] = bDiagonal ? SearchPolicies::IntegerCost::Diagonal : SearchPolicies::IntegerCost::Straight;
+		}
+		return iCount;
+	}
+
+	//hop counts from iCell, enough to spread the landmarks out, -1 for cells it cant reach
+	static void BreadthFirst(const PathfindingGrid& grid, const SearchPolicy& policy, int iCell, std::vector<std::int32_t>& vecHops, std::vector<int>& vecQueue)
+	{
+		vecHops.assign(grid.Size(), -1);
+		vecQueue.clear();
+		vecHops[iCell] = 0;
+		vecQueue.push_back(iCell);
+		int arrCells[GridDirection::iCount];
+		std::int32_t arrCosts[GridDirection::iCount];
+		for (std::size_t iNext = 0; iNext < vecQueue.size(); iNext++)
+		{
+			int iCurrentCell = vecQueue[iNext];
+			int iSteps = Steps(grid, policy, iCurrentCell, arrCells, arrCosts);
+			for (int iStep = 0; iStep < iSteps; iStep++)
+			{
+				if (vecHops[arrCells[iStep]] != -1)
+					continue;
+				vecHops[arrCells[iStep]] = vecHops[iCurrentCell] + 1;
+				vecQueue.push_back(arrCells[iStep]);
+			}
+		}
+	}
+
+	//exact costs from iCell, -1 for cells it cant reach
+	//every step costs 10 or 14 so the cells waiting to be settled are never more than 14 apart, a ring of 16 buckets
+	//indexed by cost is the whole queue, a cell is pushed again when it gets cheaper and the old entry is skipped
+	static void Dijkstra(const PathfindingGrid& grid, const SearchPolicy& policy, int iCell, std::vector<std::int32_t>& vecCosts)
+	{
+		constexpr std::int32_t iRing = 16;
+		std::vector<int> vecBuckets[iRing];
+		vecCosts.assign(grid.Size(), -1);
+		vecCosts[iCell] = 0;
+		vecBuckets[0].push_back(iCell);
+		std::size_t iQueued = 1;
+		int arrCells[GridDirection::iCount];
+		std::int32_t arrCosts[GridDirection::iCount];
+		for (std::int32_t Cost = 0; iQueued > 0; Cost++)
+		{
+			std::vector<int>& vecBucket = vecBuckets[Cost & (iRing - 1)];
+			//a step costs at least 10 so nothing lands in the bucket that is being settled
+			for (int iCurrentCell : vecBucket)
+			{
+				iQueued--;
+				//older more expensive copies of a cell
+				if (vecCosts[iCurrentCell] != Cost)
+					continue;
+				int iSteps = Steps(grid, policy, iCurrentCell, arrCells, arrCosts);
+				for (int iStep = 0; iStep < iSteps; iStep++)
+				{
+					std::int32_t NextCost = Cost + arrCosts[iStep];
+					std::int32_t& Known = vecCosts[arrCells[iStep]];
+					if (Known != -1 && Known <= NextCost)
+						continue;
+					Known = NextCost;
+					vecBuckets[NextCost & (iRing - 1)].push_back(arrCells[iStep]);
+					iQueued++;
+				}
+			}
+			vecBucket.clear();
+		}
+	}
+
+public:
+	bool Empty() const { return iLandmarks == 0; }
+	int Count() const { return iLandmarks; }
+	const glm::ivec2& Landmark(int iLandmark) const { return vecLandmarks[iLandmark]; }
+	//the distances didnt fit in 16 bits
+	bool Wide() const { return !vecWideDistances.empty(); }
+
+	void Clear()
+	{
+		iWidth = iLandmarks = 0;
+		vecDistances.clear();
+		vecDistances.shrink_to_fit();
+		vecWideDistances.clear();
+		vecWideDistances.shrink_to_fit();
+		vecLandmarks.clear();
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecDistances.capacity() * sizeof(std::uint16_t) + vecWideDistances.capacity() * sizeof(std::uint32_t) + vecLandmarks.capacity() * sizeof(glm::ivec2);
+	}
+
+	//picks up to iLandmarks landmarks by farthest point selection, starting with the cell farthest from any cell of the
+	//largest region and then always the cell farthest from every landmark so far, the picking is serial on cheap hop counts
+	//the exact distances of the landmarks are then computed on up to iThreads threads, one landmark at a time each
+	//only the largest region gets landmarks, the others fall back to the plain estimate
+	void Build(const PathfindingGrid& grid, const SearchPolicy& policy, int iLandmarks, int iThreads)
+	{
+		Clear();
+		if (iLandmarks <= 0)
+			return;
+
+		std::vector<int> vecCells, vecQueue;
+		std::vector<std::int32_t> vecHops, vecNearest;
+		//the regions on the steps of the policy, 4 connected levels split where ConnectedRegions doesnt
+		int iSeedCell = -1;
+		std::size_t iSeedRegion = 0;
+		vecNearest.assign(grid.Size(), -1);
+		for (int iCell = 0; iCell < grid.Size(); iCell++)
+		{
+			if (vecNearest[iCell] != -1 || !grid.IsWalkable(grid.Position(iCell)))
+				continue;
+			vecQueue.assign(1, iCell);
+			vecNearest[iCell] = 0;
+			int arrCells[GridDirection::iCount];
+			std::int32_t arrCosts[GridDirection::iCount];
+			for (std::size_t iNext = 0; iNext < vecQueue.size(); iNext++)
+			{
+				int iSteps = Steps(grid, policy, vecQueue[iNext], arrCells, arrCosts);
+				for (int iStep = 0; iStep < iSteps; iStep++)
+				{
+					if (vecNearest[arrCells[iStep]] != -1)
+						continue;
+					vecNearest[arrCells[iStep]] = 0;
+					vecQueue.push_back(arrCells[iStep]);
+				}
+			}
+			if (vecQueue.size() > iSeedRegion)
+			{
+				iSeedCell = iCell;
+				iSeedRegion = vecQueue.size();
+			}
+		}
+		if (iSeedCell == -1)
+			return;
+
+		BreadthFirst(grid, policy, iSeedCell, vecHops, vecQueue);
+		//hops to the nearest landmark of every cell the seed reaches
+		vecNearest = vecHops;
+		for (int iLandmark = 0; iLandmark < iLandmarks; iLandmark++)
+		{
+			int iFarthestCell = -1;
+			for (int iCell = 0; iCell < grid.Size(); iCell++)
+				if (vecNearest[iCell] > 0 && (iFarthestCell == -1 || vecNearest[iCell] > vecNearest[iFarthestCell]))
+					iFarthestCell = iCell;
+			//fewer cells than landmarks
+			if (iFarthestCell == -1)
+				break;
+			vecCells.push_back(iFarthestCell);
+			BreadthFirst(grid, policy, iFarthestCell, vecHops, vecQueue);
+			for (int iCell = 0; iCell < grid.Size(); iCell++)
+				vecNearest[iCell] = glm::min(vecNearest[iCell], vecHops[iCell]);
+		}
+
+		this->iLandmarks = static_cast<int>(vecCells.size());
+		iWidth = grid.Width();
+		for (int iCell : vecCells)
+			vecLandmarks.push_back(grid.Position(iCell));
+		std::vector<std::vector<std::int32_t>> vecCosts(vecCells.size());
+		std::atomic<int> iNextLandmark(0);
+		auto Work = [&]()
+		{
+			for (int iLandmark = iNextLandmark++; iLandmark < this->iLandmarks; iLandmark = iNextLandmark++)
+				Dijkstra(grid, policy, vecCells[iLandmark], vecCosts[iLandmark]);
+		};
+		std::vector<std::thread> vecThreads;
+		for (int iThread = 1; iThread < glm::min(iThreads, this->iLandmarks); iThread++)
+			vecThreads.emplace_back(Work);
+		Work();
+		for (auto& thread : vecThreads)
+			thread.join();
+
+		std::int32_t iFarthest = 0;
+		for (auto& vecCost : vecCosts)
+			iFarthest = glm::max(iFarthest, *std::max_element(vecCost.begin(), vecCost.end()));
+		if (iFarthest < std::numeric_limits<std::uint16_t>::max())
+			Store(vecCosts, grid.Size(), vecDistances);
+		else
+			Store(vecCosts, grid.Size(), vecWideDistances);
+	}
+
+	//the largest landmark bound between the two cells in 10/14 units, 0 if no landmark reaches both
+	std::int32_t Bound(int iCell, int iTargetCell) const
+	{
+		return vecWideDistances.empty() ? Bound(vecDistances, iCell, iTargetCell) : Bound(vecWideDistances, iCell, iTargetCell);
+	}
+
+	//the bound in the units of the cost type of the search
+	template <class Cost>
+	typename Cost::Type Estimate(int iX, int iY, const glm::ivec2& ivTargetPos) const
+	{
+		typedef typename Cost::Type CostType;
+		//an empty table bounds nothing
+		if (iLandmarks == 0)
+			return CostType(0);
+		std::int32_t iBound = Bound(iY * iWidth + iX, ivTargetPos.y * iWidth + ivTargetPos.x);
+		return static_cast<CostType>(iBound) * Cost::Straight / static_cast<CostType>(SearchPolicies::IntegerCost::Straight);
+	}
+};
@@ -0,0 +1,162 @@
+//paths found earlier, handed out again for the same query and sliced for queries between two cells of a shortest path
+//every part of a shortest path is a shortest path between its ends, so a query whose start and target both lie on a
+//cached one is answered without searching, in either direction since the grid is undirected
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingNode.h"
+#include "PathfindingGrid.h"
+
+//entries are only hit on the level generation they were found on, Pathfinder::GetLevelGeneration changes with every
+//edit of the level so nothing found before it is handed out, the least recently used entry is dropped once it is full
+class PathCache
+{
+public:
+	struct Counters
+	{
+		//same start and target, both on a cached path, and searched
+		std::size_t iHits = 0, iSubPathHits = 0, iMisses = 0;
+	};
+
+private:
+	struct Entry
+	{
+		glm::ivec2 ivStartPos, ivTargetPos;
+		std::uint32_t iGeneration;
+		//paths that arent the shortest, of HPA* or an overestimating heuristic, are only handed out whole
+		bool bShortest;
+		std::uint64_t iLastUse;
+		//from the start to the target, the start included, with the cost from the start
+		std::vector<glm::ivec2> vecCells;
+		std::vector<float> vecCosts;
+		//(cell index, position in vecCells) sorted by cell, to find the cells of a query
+		std::vector<std::pair<int, int>> vecPositions;
+	};
+	std::vector<Entry> vecEntries;
+	std::size_t iCapacity = 64;
+	std::uint64_t iUses = 0;
+	Counters counters;
+
+	static int Position(const Entry& entry, int iCell)
+	{
+		auto it = std::lower_bound(entry.vecPositions.begin(), entry.vecPositions.end(), std::make_pair(iCell, 0));
+		return it != entry.vecPositions.end() && it->first == iCell ? it->second : -1;
+	}
+
+	//the entry that is reused for the next path, a new one until the cache is full
+	Entry& Slot()
+	{
+		if (vecEntries.size() < iCapacity)
+		{
+			vecEntries.emplace_back();
+			return vecEntries.back();
+		}
+		auto it = std::min_element(vecEntries.begin(), vecEntries.end(), [](const Entry& a, const Entry& b) { return a.iLastUse < b.iLastUse; });
+		return *it;
+	}
+
+public:
+	const Counters& GetCounters() const { return counters; }
+	std::size_t Count() const { return vecEntries.size(); }
+
+	void SetCapacity(std::size_t iCapacity)
+	{
+		this->iCapacity = glm::max<std::size_t>(iCapacity, 1);
+		if (vecEntries.size() > this->iCapacity)
+		{
+			std::sort(vecEntries.begin(), vecEntries.end(), [](const Entry& a, const Entry& b) { return a.iLastUse > b.iLastUse; });
+			vecEntries.resize(this->iCapacity);
+		}
+	}
+
+	//keeps a path in the form the searches give it, target first without the start
+	void Insert(const PathfindingGrid& grid, std::uint32_t iGeneration, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos,
+		const std::vector<PathfindingNode>& vecPath, bool bShortest)
+	{
+		Entry& entry = Slot();
+		entry.ivStartPos = ivStartPos;
+		entry.ivTargetPos = ivTargetPos;
+		entry.iGeneration = iGeneration;
+		entry.bShortest = bShortest;
+		entry.iLastUse = ++iUses;
+		entry.vecCells.assign(1, ivStartPos);
+		entry.vecCosts.assign(1, 0.0f);
+		for (auto it = vecPath.rbegin(); it != vecPath.rend(); ++it)
+		{
+			entry.vecCells.push_back(it->ivGridPos);
+			entry.vecCosts.push_back(it->G);
+		}
+		entry.vecPositions.clear();
+		for (int iPosition = 0; iPosition < static_cast<int>(entry.vecCells.size()); iPosition++)
+			entry.vecPositions.push_back(std::make_pair(grid.Index(entry.vecCells[iPosition]), iPosition));
+		std::sort(entry.vecPositions.begin(), entry.vecPositions.end());
+	}
+
+	//appends the path of the query to vecPath target first without the start, with its cost, false and counted as a miss
+	//if no entry of this generation has it
+	bool Find(const PathfindingGrid& grid, std::uint32_t iGeneration, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos,
+		std::vector<PathfindingNode>& vecPath, float& fCost)
+	{
+		int iStartCell = grid.Index(ivStartPos), iTargetCell = grid.Index(ivTargetPos);
+		Entry* pEntry = nullptr;
+		int iFrom = -1, iTo = -1;
+		for (auto& entry : vecEntries)
+		{
+			if (entry.iGeneration != iGeneration)
+				continue;
+			if (entry.ivStartPos == ivStartPos && entry.ivTargetPos == ivTargetPos)
+			{
+				pEntry = &entry;
+				iFrom = 0;
+				iTo = static_cast<int>(entry.vecCells.size()) - 1;
+				counters.iHits++;
+				break;
+			}
+			if (!entry.bShortest || pEntry)
+				continue;
+			int iStart = Position(entry, iStartCell), iTarget = iStart == -1 ? -1 : Position(entry, iTargetCell);
+			if (iTarget != -1)
+			{
+				pEntry = &entry;
+				iFrom = iStart;
+				iTo = iTarget;
+			}
+		}
+		if (!pEntry)
+		{
+			counters.iMisses++;
+			return false;
+		}
+		if (!(pEntry->ivStartPos == ivStartPos && pEntry->ivTargetPos == ivTargetPos))
+			counters.iSubPathHits++;
+		pEntry->iLastUse = ++iUses;
+
+		//the costs along the slice count up from its start whichever way it runs
+		const std::vector<float>& vecCosts = pEntry->vecCosts;
+		fCost = glm::abs(vecCosts[iTo] - vecCosts[iFrom]);
+		int iStep = iTo > iFrom ? -1 : 1;
+		for (int iPosition = iTo; iPosition != iFrom; iPosition += iStep)
+			vecPath.push_back(PathfindingNode(pEntry->vecCells[iPosition], glm::abs(vecCosts[iPosition] - vecCosts[iFrom])));
+		return true;
+	}
+
+	void Clear()
+	{
+		vecEntries.clear();
+	}
+
+	void ResetCounters()
+	{
+		counters = Counters();
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		std::size_t iBytes = vecEntries.capacity() * sizeof(Entry);
+		for (auto& entry : vecEntries)
+			iBytes += entry.vecCells.capacity() * sizeof(glm::ivec2) + entry.vecCosts.capacity() * sizeof(float) + entry.vecPositions.capacity() * sizeof(std::pair<int, int>);
+		return iBytes;
+	}
+};
@@ -0,0 +1,1013 @@
+#include "Pathfinder.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+
+Pathfinder::Pathfinder() : iExpansionBudget(0), iMicrosecondBudget(0), bVisualize(true), iNextSlicedSearch(0), iNextRequestID(0), iLevelGeneration(0),
+	bCollectStats(false), mSearchMode(SEARCH_ASTAR), bJumpPointTable(false), iLandmarks(8), iLandmarkGeneration(0), bLandmarksStale(false), bFieldsStale(false), iPlannerCapacity(16), iPlannerUses(0), iRepairRadius(8), iClusterSize(0),
+	Kernel(SelectSearchKernel(LevelPolicy)), HeapKernel(Kernel), Bidirectional(SelectSearchKernel<BidirectionalKernel>(LevelPolicy)),
+	GoalFlood(SelectSearchKernel<GoalFieldKernel>(LevelPolicy))
+{
+}
+
+void Pathfinder::InsertNode(glm::ivec2 ivGridPos)
+{
+	vecPendingNodes.push_back(ivGridPos);
+}
+
+void Pathfinder::BuildGrid(int iWidth, int iHeight)
+{
+	//the workers read the level data, nothing can be in flight while it changes
+	Workers.Cancel();
+	CancelBackgroundBuilds();
+	iLevelGeneration++;
+
+	Grid.Resize(iWidth, iHeight);
+	for (auto& ivGridPos : vecPendingNodes)
+		Grid.SetWalkable(ivGridPos, true);
+	vecPendingNodes.clear();
+	vecPendingNodes.shrink_to_fit();
+
+	//the search is picked once for the whole level, every node it expands then runs the same compiled loop
+	LevelPolicy = Policy;
+	Kernel = SelectSearchKernel(LevelPolicy);
+	SearchPolicy heapPolicy = LevelPolicy;
+	heapPolicy.mOpenList = OPENLIST_HEAP;
+	HeapKernel = SelectSearchKernel(heapPolicy);
+	Bidirectional = SelectSearchKernel<BidirectionalKernel>(LevelPolicy);
+	GoalFlood = SelectSearchKernel<GoalFieldKernel>(LevelPolicy);
+	MainContext.Resize(Grid.Size(), LevelPolicy);
+	Workers.Resize(Grid.Size(), LevelPolicy);
+	//searches still pending were started on the old grid
+	for (auto& search : vecSlicedSearches)
+		if (search.context)
+			vecFreeContexts.push_back(std::move(search.context));
+	vecSlicedSearches.clear();
+	for (auto& context : vecFreeContexts)
+		context->Resize(Grid.Size(), LevelPolicy);
+	spdlog::info("Pathfinding grid {}x{} : {} bytes", iWidth, iHeight, Grid.MemoryUsage() + MainContext.MemoryUsage());
+
+	Regions.Build(Grid);
+	spdlog::info("Connected regions : {}, {} bytes", Regions.Count(), Regions.MemoryUsage());
+
+	Landmarks.Clear();
+	iLandmarkGeneration++;
+	if (LevelPolicy.mHeuristic == HEURISTIC_LANDMARKS && iLandmarks > 0)
+		BuildLandmarks();
+	GoalFields.Clear();
+	mapPlanners.clear();
+	Cooperative.Resize(Grid, LevelPolicy);
+
+	//jump points and the abstract graph assume 8 connected grids with corner cutting
+	JumpTable.Clear();
+	Hierarchy.Clear();
+	if (!LevelPolicy.SupportsPreprocessing())
+		return;
+	if (bJumpPointTable)
+		BuildJumpPointTable();
+	if (iClusterSize > 0)
+		BuildHierarchy();
+}
+
+void Pathfinder::SetWalkable(const glm::ivec2& ivGridPos, bool bWalkable)
+{
+	if (!Grid.InBounds(ivGridPos.x, ivGridPos.y) || Grid.IsWalkable(ivGridPos) == bWalkable)
+		return;
+	//the workers read the level data, the searches they are in the middle of are finished first but the queue is left
+	//for after the change
+	Workers.Pause();
+	iLevelGeneration++;
+	Grid.SetWalkable(ivGridPos, bWalkable);
+	if (bWalkable)
+		Regions.AddCell(Grid, ivGridPos);
+	else
+		Regions.RemoveCell(Grid, ivGridPos);
+
+	//the jump distances and the clusters are updated around the tile, what depends on the whole level is built again
+	//off the frame
+	//a new obstacle only makes paths longer and the landmark bounds stay lower bounds, they are kept until a tile opens
+	if (bWalkable && (!Landmarks.Empty() || LandmarkBuild.Running()))
+	{
+		Landmarks.Clear();
+		iLandmarkGeneration++;
+		if (LandmarkBuild.Running())
+			bLandmarksStale = true;
+		else
+			StartLandmarkBuild();
+	}
+	if (!JumpTable.Empty())
+		JumpTable.TileChanged(Grid, ivGridPos);
+	if (!Hierarchy.Empty())
+		Hierarchy.TileChanged(Grid, ivGridPos);
+	if (!GoalFields.Empty() || FieldBuild.Running())
+		RefreshGoalDistanceFields();
+	Workers.Resume();
+	for (auto& planner : mapPlanners)
+		planner.second.planner->TileChanged(Grid, ivGridPos);
+	Cooperative.TileChanged(Grid, ivGridPos);
+}
+
+void Pathfinder::Clear()
+{
+	//searches still running were for the old level
+	Workers.Cancel();
+	CancelBackgroundBuilds();
+	iLevelGeneration++;
+	mapLatestRequests.clear();
+	vecReadyResults.clear();
+	for (auto& search : vecSlicedSearches)
+		if (search.context)
+			vecFreeContexts.push_back(std::move(search.context));
+	vecSlicedSearches.clear();
+	Grid.Clear();
+	Regions.Clear();
+	JumpTable.Clear();
+	Landmarks.Clear();
+	GoalFields.Clear();
+	mapPlanners.clear();
+	Cooperative.Clear();
+	Hierarchy.Clear();
+	vecPendingNodes.clear();
+}
+
+void Pathfinder::StartWorkers(int iThreads)
+{
+	Workers.Start(iThreads, Grid.Size(), LevelPolicy, [this](const PathRequest& request, SearchContext& context, PathResult& result)
+		{
+			return FindPath(request, context, result);
+		});
+	spdlog::info("Pathfinding workers : {}", iThreads);
+}
+
+void Pathfinder::SetSearchBudget(int iExpansions, int iMicroseconds)
+{
+	iExpansionBudget = iExpansions;
+	iMicrosecondBudget = iMicroseconds;
+}
+
+void Pathfinder::BuildHierarchy()
+{
+	auto timeStart = std::chrono::steady_clock::now();
+	Hierarchy.Build(Grid, iClusterSize);
+	float fMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+	spdlog::info("Hierarchical graph {}x{} clusters of {} : {} entrances, {:.3f} ms, {} bytes", Grid.Width(), Grid.Height(), iClusterSize, Hierarchy.NodeCount(), fMilliseconds, Hierarchy.MemoryUsage());
+}
+
+void Pathfinder::BuildLandmarks()
+{
+	auto timeStart = std::chrono::steady_clock::now();
+	Landmarks.Build(Grid, LevelPolicy, iLandmarks, static_cast<int>(std::thread::hardware_concurrency()));
+	float fMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+	spdlog::info("Landmarks {}x{} : {} landmarks, {} bit distances, {:.3f} ms, {} bytes", Grid.Width(), Grid.Height(), Landmarks.Count(), Landmarks.Wide() ? 32 : 16,
+		fMilliseconds, Landmarks.MemoryUsage());
+}
+
+//builds the landmarks of the current grid off the frame, ProcessBackgroundBuilds takes them once they are done
+void Pathfinder::StartLandmarkBuild()
+{
+	bLandmarksStale = false;
+	SearchPolicy policy = LevelPolicy;
+	int iCount = iLandmarks;
+	LandmarkBuild.Start(Grid, [this, policy, iCount](const PathfindingGrid& grid)
+		{
+			RebuiltLandmarks.Build(grid, policy, iCount, static_cast<int>(std::thread::hardware_concurrency()));
+		});
+}
+
+//builds the fields of every cached goal again on the current grid off the frame
+void Pathfinder::StartGoalFieldBuild()
+{
+	bFieldsStale = false;
+	vecFieldGoals.clear();
+	GoalFields.Goals(vecFieldGoals);
+	vecRebuiltFields.resize(vecFieldGoals.size());
+	SearchPolicy policy = LevelPolicy;
+	SearchKernelFunctions flood = GoalFlood;
+	FieldBuild.Start(Grid, [this, policy, flood](const PathfindingGrid& grid)
+		{
+			SearchContext context;
+			context.Resize(grid.Size(), policy);
+			for (std::size_t iField = 0; iField < vecFieldGoals.size(); iField++)
+				vecRebuiltFields[iField].Build(grid, context, policy, flood, vecFieldGoals[iField]);
+		});
+}
+
+//swaps in what was built off the frame, or builds it again if the level changed in a way the build doesnt cover
+void Pathfinder::ProcessBackgroundBuilds()
+{
+	if (LandmarkBuild.Done())
+	{
+		LandmarkBuild.Finish();
+		if (bLandmarksStale)
+			StartLandmarkBuild();
+		else
+		{
+			//the workers read the landmarks
+			Workers.Pause();
+			std::swap(Landmarks, RebuiltLandmarks);
+			iLandmarkGeneration++;
+			Workers.Resume();
+			RebuiltLandmarks.Clear();
+			spdlog::info("Landmarks rebuilt : {} landmarks, {} bytes", Landmarks.Count(), Landmarks.MemoryUsage());
+		}
+	}
+	if (FieldBuild.Done())
+	{
+		FieldBuild.Finish();
+		if (bFieldsStale)
+			StartGoalFieldBuild();
+		else
+		{
+			//the workers read the fields, goals dropped while the build ran are skipped
+			Workers.Pause();
+			for (std::size_t iField = 0; iField < vecFieldGoals.size(); iField++)
+				GoalFields.Replace(Grid.Index(vecFieldGoals[iField]), vecRebuiltFields[iField]);
+			Workers.Resume();
+			vecRebuiltFields.clear();
+			spdlog::info("Goal distance fields rebuilt : {} fields", vecFieldGoals.size());
+		}
+	}
+}
+
+//the level is replaced, whatever is being built for the old one is dropped
+void Pathfinder::CancelBackgroundBuilds()
+{
+	LandmarkBuild.Finish();
+	RebuiltLandmarks.Clear();
+	bLandmarksStale = false;
+	FieldBuild.Finish();
+	vecRebuiltFields.clear();
+	bFieldsStale = false;
+}
+
+void Pathfinder::SetGoalFieldCapacity(std::size_t iCapacity)
+{
+	//the workers read the fields
+	Workers.Wait();
+	GoalFields.SetCapacity(iCapacity);
+}
+
+const GoalDistanceField* Pathfinder::GetGoalDistanceField(const glm::ivec2& ivGoalPos, bool bPinned)
+{
+	if (!Grid.IsWalkable(ivGoalPos))
+		return nullptr;
+	const GoalDistanceField* pField = GoalFields.Use(Grid.Index(ivGoalPos));
+	if (pField && !bPinned)
+		return pField;
+	return BuildGoalDistanceField(ivGoalPos, bPinned);
+}
+
+const GoalDistanceField* Pathfinder::BuildGoalDistanceField(const glm::ivec2& ivGoalPos, bool bPinned)
+{
+	//the workers read the fields
+	Workers.Wait();
+	GoalDistanceField& field = GoalFields.Insert(Grid.Index(ivGoalPos), bPinned);
+	//pinning a field that is already there doesnt build it again
+	if (field.Width() == Grid.Width() && field.Height() == Grid.Height() && field.Goal() == ivGoalPos)
+		return &field;
+	auto timeStart = std::chrono::steady_clock::now();
+	field.Build(Grid, MainContext, LevelPolicy, GoalFlood, ivGoalPos);
+	float fMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+	spdlog::info("Goal distance field ({}, {}) : {} cells, {:.3f} ms, {} bytes, {} fields", ivGoalPos.x, ivGoalPos.y, MainContext.iExpansions, fMilliseconds, field.MemoryUsage(), GoalFields.Count());
+	return &field;
+}
+
+const GoalDistanceField* Pathfinder::FindGoalDistanceField(const glm::ivec2& ivGoalPos) const
+{
+	return Grid.IsWalkable(ivGoalPos) ? GoalFields.Find(Grid.Index(ivGoalPos)) : nullptr;
+}
+
+const GoalDistanceField* Pathfinder::HoldGoalDistanceField(const glm::ivec2& ivGoalPos)
+{
+	const GoalDistanceField* pField = GetGoalDistanceField(ivGoalPos);
+	if (pField)
+		GoalFields.Hold(Grid.Index(ivGoalPos));
+	return pField;
+}
+
+void Pathfinder::ReleaseGoalDistanceField(const glm::ivec2& ivGoalPos)
+{
+	if (Grid.InBounds(ivGoalPos.x, ivGoalPos.y))
+		GoalFields.Release(Grid.Index(ivGoalPos));
+}
+
+//a field is a flood of the whole level, so the fields are marked stale and built again off the frame, until then flow
+//field queries search and followers wait, a field whose goal was walled is dropped with its holds
+void Pathfinder::RefreshGoalDistanceFields()
+{
+	//vecFieldGoals belongs to the build while it runs
+	std::vector<glm::ivec2> vecGoals;
+	GoalFields.Goals(vecGoals);
+	for (auto& ivGoalPos : vecGoals)
+		if (!Grid.IsWalkable(ivGoalPos))
+			GoalFields.Erase(Grid.Index(ivGoalPos));
+	GoalFields.MarkStale();
+	if (FieldBuild.Running())
+		bFieldsStale = true;
+	else if (!GoalFields.Empty())
+		StartGoalFieldBuild();
+}
+
+void Pathfinder::StepCooperativeAgents()
+{
+	//fields are built on the calling thread like any other, the workers are waited for if one has to be
+	Cooperative.Tick(Grid, [this](const glm::ivec2& ivGoalPos) { return GetGoalDistanceField(ivGoalPos); });
+}
+
+void Pathfinder::BuildJumpPointTable()
+{
+	auto timeStart = std::chrono::steady_clock::now();
+	JumpTable.Build(Grid);
+	float fMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+	spdlog::info("Jump point table {}x{} : {:.3f} ms, {} bytes", Grid.Width(), Grid.Height(), fMilliseconds, JumpTable.MemoryUsage());
+}
+
+std::uint32_t Pathfinder::Submit(const PathQuery& query)
+{
+	PathRequest request{ query, mSearchMode, ++iNextRequestID, bVisualize };
+	mapLatestRequests[query.iAgent] = request.iRequestID;
+
+	//the planners keep their state per agent and arent shared with the workers, they are repaired a slice at a time
+	//on the calling thread whatever else runs the searches
+	if (mSearchMode == SEARCH_DSTAR_LITE)
+		StartSlicedSearch(request);
+	else if (Workers.Running())
+		Workers.Submit(request);
+	else if (iExpansionBudget > 0 || iMicrosecondBudget > 0)
+		StartSlicedSearch(request);
+	else
+	{
+		PathResult result(query.iAgent, request.iRequestID);
+		TakeSpareBuffers(result);
+		bool bFound = FindPath(request, MainContext, result);
+		RecordStats(result.Stats);
+		if (bFound)
+			ReceiveResult(result);
+		else
+			Recycle(result);
+	}
+	return request.iRequestID;
+}
+
+void Pathfinder::Supersede(std::uint32_t iAgent, PathResult& result)
+{
+	result.iAgent = iAgent;
+	result.iRequestID = ++iNextRequestID;
+	mapLatestRequests[iAgent] = result.iRequestID;
+	TakeSpareBuffers(result);
+}
+
+void Pathfinder::Update(std::vector<PathResult>& vecResults)
+{
+	ProcessBackgroundBuilds();
+	ProcessSlicedSearches();
+
+	//paths the workers found since the last call are delivered here on the calling thread
+	Workers.TakeResults(vecWorkerResults);
+	for (auto& result : vecWorkerResults)
+		ReceiveResult(result);
+	vecWorkerResults.clear();
+	SEARCH_STAT(Workers.TakeStats(vecWorkerStats));
+	for (auto& stats : vecWorkerStats)
+		RecordStats(stats);
+	vecWorkerStats.clear();
+
+	for (auto& result : vecReadyResults)
+		vecResults.push_back(std::move(result));
+	vecReadyResults.clear();
+}
+
+void Pathfinder::Wait()
+{
+	Workers.Wait();
+	while (!vecSlicedSearches.empty())
+		ProcessSlicedSearches();
+	while (LandmarkBuild.Running() || FieldBuild.Running())
+	{
+		LandmarkBuild.Join();
+		FieldBuild.Join();
+		ProcessBackgroundBuilds();
+	}
+}
+
+bool Pathfinder::FindPath(const PathQuery& query, PathResult& result)
+{
+	PathRequest request{ query, mSearchMode, ++iNextRequestID, bVisualize };
+	result.iAgent = query.iAgent;
+	result.iRequestID = request.iRequestID;
+	bool bFound = mSearchMode == SEARCH_DSTAR_LITE ? Replan(request, result) : FindPath(request, MainContext, result);
+	RecordStats(result.Stats);
+	return bFound;
+}
+
+void Pathfinder::SetStatsCollection(bool bCollectStats)
+{
+	this->bCollectStats = bCollectStats;
+	if (!bCollectStats)
+		vecStats.clear();
+}
+
+void Pathfinder::TakeStats(std::vector<SearchStats>& vecOut)
+{
+	for (auto& stats : vecStats)
+		vecOut.push_back(stats);
+	vecStats.clear();
+}
+
+void Pathfinder::EnableStatsLog(std::size_t iRecords)
+{
+	StatsSink = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(iRecords);
+	StatsSink->set_pattern("%v");
+	StatsLog = std::make_shared<spdlog::logger>("pathfinding-stats", StatsSink);
+}
+
+std::vector<std::string> Pathfinder::GetStatsLog(std::size_t iRecords) const
+{
+	if (!StatsSink)
+		return std::vector<std::string>();
+	return StatsSink->last_formatted(iRecords);
+}
+
+void Pathfinder::RecordStats(const SearchStats& stats)
+{
+#if PATHFINDING_STATS
+	if (bCollectStats)
+		vecStats.push_back(stats);
+	if (StatsLog)
+		StatsLog->info("agent {} request {} {} {} : {:.1f} us, {} expanded, {} generated, {} reopened, {} peak open, {} closed, {} heuristics, {} allocations",
+			stats.iAgent, stats.iRequestID, SearchModeName(static_cast<SearchMode>(stats.iSearchMode)), stats.bFound ? "found" : "failed", stats.fMicroseconds,
+			stats.iExpansions, stats.iGenerated, stats.iReopened, stats.iPeakOpen, stats.iPeakClosed, stats.iHeuristicCalls, stats.iAllocations);
+#else
+	(void)stats;
+#endif
+}
+
+void Pathfinder::RefinePath(std::vector<PathfindingNode>& vecPath, std::vector<glm::ivec2>& vecWaypoints)
+{
+	while (!vecWaypoints.empty() && vecPath.size() < iRefineLookahead)
+		RefineWaypoint(MainContext, vecPath, vecWaypoints);
+}
+
+void Pathfinder::Recycle(PathResult& result)
+{
+	if (result.Capacity() == 0)
+		return;
+	result.Clear();
+	if (Workers.Running())
+		Workers.Recycle(result);
+	else
+	{
+		vecSpareResults.emplace_back();
+		vecSpareResults.back().SwapBuffers(result);
+	}
+}
+
+//gives a result the buffers of an earlier one, the visited buffer is swapped into the context for the next search
+void Pathfinder::TakeSpareBuffers(PathResult& result)
+{
+	if (vecSpareResults.empty())
+		return;
+	result.SwapBuffers(vecSpareResults.back());
+	vecSpareResults.pop_back();
+}
+
+void Pathfinder::ReceiveResult(PathResult& result)
+{
+	auto it = mapLatestRequests.find(result.iAgent);
+	if (it == mapLatestRequests.end() || it->second != result.iRequestID)
+	{
+		Recycle(result);
+		return;
+	}
+	//the entry stays so the agents next query doesnt have to allocate it again, 0 is never a request id
+	it->second = 0;
+	vecReadyResults.push_back(std::move(result));
+}
+
+//the search itself, only reads the level data and writes to the context and result so it can run on any thread
+//returns false if there is no path
+bool Pathfinder::FindPath(const PathRequest& request, SearchContext& context, PathResult& result) const
+{
+	SearchStatus status;
+	{
+		SEARCH_STAT(SearchStatsScope statsScope(context.Stats));
+		status = BeginSearch(request, context, result);
+		if (status == SEARCH_RUNNING)
+			status = ContinueSearch(request, context, result, -1);
+	}
+	FinishStats(context, result, status);
+	return status == SEARCH_FOUND;
+}
+
+//the D* Lite plan of the agent made to the end, for FindPath
+bool Pathfinder::Replan(const PathRequest& request, PathResult& result)
+{
+	SearchStatus status;
+	{
+		SEARCH_STAT(SearchStatsScope statsScope(result.Stats));
+		status = BeginReplan(request, result);
+		if (status == SEARCH_RUNNING)
+			status = ContinueReplan(request, result, -1);
+	}
+	return status == SEARCH_FOUND;
+}
+
+//after the same checks as BeginSearch moves the D* Lite plan of the agent to the query, or makes one on its first query
+SearchStatus Pathfinder::BeginReplan(const PathRequest& request, PathResult& result)
+{
+	const PathQuery& query = request.query;
+	SearchStats& stats = result.Stats;
+	stats = SearchStats();
+	stats.iAgent = query.iAgent;
+	stats.iRequestID = request.iRequestID;
+	stats.iSearchMode = request.mSearchMode;
+	if (!Grid.IsWalkable(query.ivStartPos) || !Grid.IsWalkable(query.ivTargetPos) || !Regions.Connected(Grid.Index(query.ivStartPos), Grid.Index(query.ivTargetPos)))
+		return SEARCH_FAILED;
+	PlannerOf(query.iAgent).Begin(Grid, query.ivStartPos, query.ivTargetPos, iRepairRadius);
+	return SEARCH_RUNNING;
+}
+
+//repairs the plan at most iMaxExpansions expansions further, a negative count runs it to the end, the path is only
+//read off once the agent is consistent again
+SearchStatus Pathfinder::ContinueReplan(const PathRequest& request, PathResult& result, int iMaxExpansions)
+{
+	auto it = mapPlanners.find(request.query.iAgent);
+	//dropped while it was being repaired
+	if (it == mapPlanners.end())
+		return SEARCH_FAILED;
+	DStarLite& planner = *it->second.planner;
+	bool bDone = planner.Continue(Grid, iMaxExpansions, request.bVisualize ? &result.vecVisitedCells : nullptr);
+	result.Stats.iExpansions = planner.Expansions();
+	if (!bDone)
+		return SEARCH_RUNNING;
+	result.Stats.bFound = planner.Path(Grid, result.vecPath, result.fCost);
+	return result.Stats.bFound ? SEARCH_FOUND : SEARCH_FAILED;
+}
+
+//the planner of the agent, a new one while there are fewer than iPlannerCapacity, after that the agent takes over the
+//one used longest ago by an agent that isnt being repaired, with its memory, and plans from scratch
+DStarLite& Pathfinder::PlannerOf(std::uint32_t iAgent)
+{
+	auto it = mapPlanners.find(iAgent);
+	if (it == mapPlanners.end())
+	{
+		std::unique_ptr<DStarLite> planner;
+		if (mapPlanners.size() >= iPlannerCapacity)
+		{
+			auto itOldest = mapPlanners.end();
+			for (auto itPlanner = mapPlanners.begin(); itPlanner != mapPlanners.end(); ++itPlanner)
+			{
+				std::uint32_t iOtherAgent = itPlanner->first;
+				bool bRepairing = std::any_of(vecSlicedSearches.begin(), vecSlicedSearches.end(), [iOtherAgent](const SlicedSearch& search)
+					{
+						return search.request.query.iAgent == iOtherAgent && search.request.mSearchMode == SEARCH_DSTAR_LITE;
+					});
+				if (!bRepairing && (itOldest == mapPlanners.end() || itPlanner->second.iLastUse < itOldest->second.iLastUse))
+					itOldest = itPlanner;
+			}
+			if (itOldest != mapPlanners.end())
+			{
+				planner = std::move(itOldest->second.planner);
+				mapPlanners.erase(itOldest);
+			}
+		}
+		if (!planner)
+			planner = std::make_unique<DStarLite>();
+		planner->Resize(Grid.Size(), LevelPolicy);
+		it = mapPlanners.emplace(iAgent, Planner{ std::move(planner), 0 }).first;
+	}
+	it->second.iLastUse = ++iPlannerUses;
+	return *it->second.planner;
+}
+
+void Pathfinder::SetPlannerCapacity(std::size_t iCapacity)
+{
+	iPlannerCapacity = glm::max<std::size_t>(iCapacity, 1);
+	while (mapPlanners.size() > iPlannerCapacity)
+	{
+		auto itOldest = std::min_element(mapPlanners.begin(), mapPlanners.end(), [](const auto& a, const auto& b) { return a.second.iLastUse < b.second.iLastUse; });
+		mapPlanners.erase(itOldest);
+	}
+}
+
+//hands the record of a finished search to its result
+void Pathfinder::FinishStats(SearchContext& context, PathResult& result, SearchStatus status) const
+{
+	context.Stats.iExpansions = context.iExpansions;
+	context.Stats.bFound = status == SEARCH_FOUND;
+	result.Stats = context.Stats;
+}
+
+//checks the request and puts the start node on the openlist, hierarchical searches are cheap and finish right here
+SearchStatus Pathfinder::BeginSearch(const PathRequest& request, SearchContext& context, PathResult& result) const
+{
+	const PathQuery& query = request.query;
+	context.iExpansions = 0;
+	context.Stats = SearchStats();
+	context.Stats.iAgent = query.iAgent;
+	context.Stats.iRequestID = request.iRequestID;
+	context.Stats.iSearchMode = request.mSearchMode;
+	context.SearchSpace.bRecordVisited = request.bVisualize;
+	context.bParallelFrontiers = request.mSearchMode == SEARCH_BIDIRECTIONAL_PARALLEL;
+	//jump point searches keep to octile
+	context.pLandmarks = Landmarks.Empty() || !UsesKernel(request) ? nullptr : &Landmarks;
+	context.iLandmarkGeneration = iLandmarkGeneration;
+	//start or target on an obstacle or outside the map, there is no path
+	if (!Grid.IsWalkable(query.ivStartPos) || !Grid.IsWalkable(query.ivTargetPos))
+		return SEARCH_FAILED;
+	//the target is walled off, without this the search would flood the whole region before giving up
+	if (!Regions.Connected(Grid.Index(query.ivStartPos), Grid.Index(query.ivTargetPos)))
+		return SEARCH_FAILED;
+
+	//a goal with a field needs no search, the path is the walk down the field, without one or while it is being built
+	//again after the level changed the plain search runs
+	if (request.mSearchMode == SEARCH_FLOW_FIELD)
+	{
+		const GoalDistanceField* pField = GoalFields.Find(Grid.Index(query.ivTargetPos));
+		if (pField && !pField->Stale())
+			return pField->Descend(query.ivStartPos, result.vecPath, result.fCost) ? SEARCH_FOUND : SEARCH_FAILED;
+	}
+
+	//long queries go through the abstract graph, anything closer than a cluster is cheap enough for the plain search
+	//and would only get a detour through the entrances
+	if (request.mSearchMode == SEARCH_HPA && !Hierarchy.Empty() && Heuristic(query.ivStartPos, query.ivTargetPos) >= static_cast<float>(Hierarchy.ClusterSize()))
+		return FindHierarchical(query, context, result) ? SEARCH_FOUND : SEARCH_FAILED;
+
+	//jump point searches start the same way on the heap, the kernel of a level that supports them uses the octile heuristic
+	KernelOf(request).fnBegin(Grid, context, query.ivStartPos, query.ivTargetPos);
+	return SEARCH_RUNNING;
+}
+
+//expands at most iMaxExpansions nodes of a search BeginSearch started, a negative count runs it to the end
+//everything the search needs to go on is in the context so it can be continued in a later frame
+SearchStatus Pathfinder::ContinueSearch(const PathRequest& request, SearchContext& context, PathResult& result, int iMaxExpansions) const
+{
+	if (UsesKernel(request))
+		return KernelOf(request).fnContinue(Grid, context, result, request.query.ivStartPos, request.query.ivTargetPos, iMaxExpansions);
+
+	switch (LevelPolicy.mCostType)
+	{
+	case COST_INTEGER: return ContinueJumpPoints<SearchPolicies::IntegerCost>(request, context, result, iMaxExpansions);
+	case COST_INTEGER_FINE: return ContinueJumpPoints<SearchPolicies::FineIntegerCost>(request, context, result, iMaxExpansions);
+	default: return ContinueJumpPoints<SearchPolicies::FloatCost>(request, context, result, iMaxExpansions);
+	}
+}
+
+//the jump point search loop, in the cost type of the level
+template <class Cost>
+SearchStatus Pathfinder::ContinueJumpPoints(const PathRequest& request, SearchContext& context, PathResult& result, int iMaxExpansions) const
+{
+	PathfindingHeap<typename Cost::Type>& openList = context.template OpenListOf<PathfindingHeap<typename Cost::Type>>();
+	int iStartCell = Grid.Index(request.query.ivStartPos);
+	int iTargetCell = Grid.Index(request.query.ivTargetPos);
+	glm::ivec2 ivTargetPos = request.query.ivTargetPos;
+	//without the table JPS+ falls back to scanning
+	bool bJumpTable = request.mSearchMode == SEARCH_JPS_PLUS && !JumpTable.Empty();
+
+	//start the loop for traversal
+	//if the openlist gets empty that means automatically the path is invalid
+	for (int iExpansions = 0; iMaxExpansions < 0 || iExpansions < iMaxExpansions; iExpansions++)
+	{
+		if (openList.Empty())
+			return SEARCH_FAILED;
+
+		//get the node with the least F from the openlist
+		int iCurrentCell = openList.Pop().iCell;
+		context.iExpansions++;
+
+		//or if we have finally reached our goal
+		if (iCurrentCell == iTargetCell)
+		{
+			ConstructPath<Cost>(context, result, iStartCell, iTargetCell);
+			return SEARCH_FOUND;
+		};
+
+		//it has been removed from the openlist so put it in closedlist
+		context.SearchSpace.Close(iCurrentCell);
+		SEARCH_STAT(context.Stats.iPeakClosed++);
+
+		//now get the jump points
+		JumpPoints<Cost>(context, iCurrentCell, ivTargetPos, bJumpTable);
+	}
+
+	return openList.Empty() ? SEARCH_FAILED : SEARCH_RUNNING;
+}
+
+//begins a search that ProcessSlicedSearches continues every Update, a newer request of the same agent
+//takes over the search it already has running
+void Pathfinder::StartSlicedSearch(const PathRequest& request)
+{
+	bool bPlanner = request.mSearchMode == SEARCH_DSTAR_LITE;
+	auto it = std::find_if(vecSlicedSearches.begin(), vecSlicedSearches.end(), [&request](const SlicedSearch& search)
+		{
+			return search.request.query.iAgent == request.query.iAgent;
+		});
+	if (it != vecSlicedSearches.end())
+	{
+		it->request = request;
+		it->result.iRequestID = request.iRequestID;
+		it->result.vecPath.clear();
+		it->result.vecWaypoints.clear();
+		it->result.fCost = 0.0f;
+	}
+	else
+	{
+		vecSlicedSearches.emplace_back(request, nullptr);
+		it = vecSlicedSearches.end() - 1;
+		TakeSpareBuffers(it->result);
+	}
+	//the D* Lite planners keep their own state, only the other searches need a context
+	if (!bPlanner && !it->context)
+	{
+		if (!vecFreeContexts.empty())
+		{
+			it->context = std::move(vecFreeContexts.back());
+			vecFreeContexts.pop_back();
+		}
+		else
+		{
+			it->context = std::make_unique<SearchContext>();
+			it->context->Resize(Grid.Size(), LevelPolicy);
+		}
+	}
+
+	SearchStatus status;
+	{
+		SEARCH_STAT(SearchStatsScope statsScope(bPlanner ? it->result.Stats : it->context->Stats));
+		status = bPlanner ? BeginReplan(it->request, it->result) : BeginSearch(it->request, *it->context, it->result);
+	}
+	if (status != SEARCH_RUNNING)
+		FinishSlicedSearch(it - vecSlicedSearches.begin(), status);
+}
+
+void Pathfinder::FinishSlicedSearch(std::size_t iSearch, SearchStatus status)
+{
+	SlicedSearch& search = vecSlicedSearches[iSearch];
+	//the D* Lite plans keep their record in the result
+	if (search.request.mSearchMode != SEARCH_DSTAR_LITE)
+		FinishStats(*search.context, search.result, status);
+	RecordStats(search.result.Stats);
+	if (status == SEARCH_FOUND)
+		ReceiveResult(search.result);
+	else
+		Recycle(search.result);
+	if (search.context)
+		vecFreeContexts.push_back(std::move(search.context));
+	vecSlicedSearches.erase(vecSlicedSearches.begin() + iSearch);
+}
+
+//spends the budget of this frame on the pending searches, the ones with the highest priority take turns
+//of iSliceExpansions each and the lower ones only get what is left once those are done
+//without a budget only the D* Lite plans are sliced and they get iPlannerExpansions
+void Pathfinder::ProcessSlicedSearches()
+{
+	auto timeStart = std::chrono::steady_clock::now();
+	int iBudget = iExpansionBudget > 0 || iMicrosecondBudget > 0 ? iExpansionBudget : iPlannerExpansions;
+	int iExpansions = 0;
+	while (!vecSlicedSearches.empty())
+	{
+		int iPriority = vecSlicedSearches.front().request.query.iPriority;
+		for (auto& search : vecSlicedSearches)
+			iPriority = glm::max(iPriority, search.request.query.iPriority);
+
+		//next search with that priority after the one that had the last turn
+		std::size_t iSearch = iNextSlicedSearch % vecSlicedSearches.size();
+		while (vecSlicedSearches[iSearch].request.query.iPriority != iPriority)
+			iSearch = (iSearch + 1) % vecSlicedSearches.size();
+
+		SlicedSearch& search = vecSlicedSearches[iSearch];
+		bool bPlanner = search.request.mSearchMode == SEARCH_DSTAR_LITE;
+		//the landmarks the search began with were cleared or rebuilt since its last slice, going on with other bounds
+		//would change its heuristic partway and since closed nodes are never reopened the path could come out longer
+		//than the shortest, so it starts over on the current table
+		if (!bPlanner && search.context->pLandmarks && search.context->iLandmarkGeneration != iLandmarkGeneration)
+		{
+			SearchStatus status;
+			{
+				SEARCH_STAT(SearchStatsScope statsScope(search.context->Stats));
+				status = BeginSearch(search.request, *search.context, search.result);
+			}
+			if (status != SEARCH_RUNNING)
+			{
+				FinishSlicedSearch(iSearch, status);
+				iNextSlicedSearch = iSearch;
+				continue;
+			}
+		}
+		int iSlice = iBudget > 0 ? glm::min(iSliceExpansions, iBudget - iExpansions) : iSliceExpansions;
+		std::size_t iExpansionsBefore = bPlanner ? search.result.Stats.iExpansions : search.context->iExpansions;
+		SearchStatus status;
+		{
+			SEARCH_STAT(SearchStatsScope statsScope(bPlanner ? search.result.Stats : search.context->Stats));
+			status = bPlanner ? ContinueReplan(search.request, search.result, iSlice) : ContinueSearch(search.request, *search.context, search.result, iSlice);
+		}
+		//a plan still running used its whole slice, part of it can be cells that only had their key updated
+		if (bPlanner && status == SEARCH_RUNNING)
+			iExpansions += iSlice;
+		else
+			iExpansions += static_cast<int>((bPlanner ? search.result.Stats.iExpansions : search.context->iExpansions) - iExpansionsBefore);
+
+		if (status == SEARCH_RUNNING)
+			iNextSlicedSearch = iSearch + 1;
+		else
+		{
+			//the search after it moves into its slot
+			FinishSlicedSearch(iSearch, status);
+			iNextSlicedSearch = iSearch;
+		}
+
+		if (iBudget > 0 && iExpansions >= iBudget)
+			break;
+		if (iMicrosecondBudget > 0 && std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count() >= iMicrosecondBudget)
+			break;
+	}
+}
+
+//HPA*, finds the abstract path and refines it into tiles, either all at once or just the first segment
+//with bRefineLazily where the rest is refined by RefinePath while the agent walks
+bool Pathfinder::FindHierarchical(const PathQuery& query, SearchContext& context, PathResult& result) const
+{
+	if (!Hierarchy.FindPath(Grid, query.ivStartPos, query.ivTargetPos, context.vecWaypoints, context.HierarchyScratch))
+		return false;
+
+	if (query.bRefineLazily)
+	{
+		result.vecWaypoints.assign(context.vecWaypoints.rbegin(), context.vecWaypoints.rend());
+		RefineWaypoint(context, result.vecPath, result.vecWaypoints);
+	}
+	else
+	{
+		//the segments are refined from the target back so every one of them is appended to the path
+		for (std::size_t iWaypoint = context.vecWaypoints.size() - 1; iWaypoint > 0; iWaypoint--)
+		{
+			context.vecRefinedTiles.clear();
+			if (!Hierarchy.Refine(Grid, context.vecWaypoints[iWaypoint - 1], context.vecWaypoints[iWaypoint], context.vecRefinedTiles, context.HierarchyScratch))
+				return false;
+			result.vecPath.insert(result.vecPath.end(), context.vecRefinedTiles.rbegin(), context.vecRefinedTiles.rend());
+		}
+		CountSegmentCosts(query.ivStartPos, 0.0f, result.vecPath.begin(), result.vecPath.end());
+		result.fCost = result.vecPath.empty() ? 0.0f : result.vecPath.front().G;
+	}
+
+	//display the entrances the abstract path went through
+	if (context.SearchSpace.bRecordVisited)
+		for (auto& ivWaypoint : context.vecWaypoints)
+			result.vecVisitedCells.push_back(Grid.Index(ivWaypoint));
+	return true;
+}
+
+//refines the segment between the last two waypoints onto the front of vecPath, both hold the path target first
+//the front of a lazily refined path is only ever a segment or two long so the insert stays cheap
+void Pathfinder::RefineWaypoint(SearchContext& context, std::vector<PathfindingNode>& vecPath, std::vector<glm::ivec2>& vecWaypoints) const
+{
+	glm::ivec2 ivFromPos = vecWaypoints.back();
+	vecWaypoints.pop_back();
+	if (vecWaypoints.empty())
+		return;
+
+	context.vecRefinedTiles.clear();
+	if (!Hierarchy.Refine(Grid, ivFromPos, vecWaypoints.back(), context.vecRefinedTiles, context.HierarchyScratch))
+	{
+		vecWaypoints.clear();
+		return;
+	}
+	//the segment goes on from the tile the path ends at, or from the start for the first one
+	float fFromCost = vecPath.empty() ? 0.0f : vecPath.front().G;
+	vecPath.insert(vecPath.begin(), context.vecRefinedTiles.rbegin(), context.vecRefinedTiles.rend());
+	CountSegmentCosts(ivFromPos, fFromCost, vecPath.begin(), vecPath.begin() + context.vecRefinedTiles.size());
+	//the last waypoint is the target, nothing left to refine
+	if (vecWaypoints.size() == 1)
+		vecWaypoints.clear();
+}
+
+//the refined tiles carry no G, the steps of the segment, target first like the path, are counted from ivFromPos whose
+//cost is fFromCost, in the cost type of the level so a whole path costs what a search would have returned
+void Pathfinder::CountSegmentCosts(const glm::ivec2& ivFromPos, float fFromCost, std::vector<PathfindingNode>::iterator itBegin, std::vector<PathfindingNode>::iterator itEnd) const
+{
+	glm::ivec2 ivPrevPos = ivFromPos;
+	int iStraightSteps = 0, iDiagonalSteps = 0;
+	for (auto it = std::make_reverse_iterator(itEnd); it != std::make_reverse_iterator(itBegin); ++it)
+	{
+		glm::ivec2 ivDelta = glm::abs(it->ivGridPos - ivPrevPos);
+		if (ivDelta.x != 0 && ivDelta.y != 0)
+			iDiagonalSteps++;
+		else if (ivDelta.x != 0 || ivDelta.y != 0)
+			iStraightSteps++;
+		ivPrevPos = it->ivGridPos;
+		it->G = fFromCost + PathCost(LevelPolicy.mCostType, iStraightSteps, iDiagonalSteps);
+	}
+}
+
+float Pathfinder::Heuristic(const glm::ivec2& ivCurrentPos, const glm::ivec2& ivTargetPos) const
+{
+	float absX = static_cast<float>(glm::abs(ivCurrentPos.x - ivTargetPos.x));
+	float absY = static_cast<float>(glm::abs(ivCurrentPos.y - ivTargetPos.y));
+	float D = 1.0f, D2 = 1.414f;
+	return D * (absX + absY) + (D2 - 2.0f * D) * glm::min(absX, absY);
+}
+
+//plain A*, the hierarchical searches that are too short for the abstract graph, and every mode on a level
+//whose policy jump points dont support run the kernel, only jump point search has its own loop
+bool Pathfinder::UsesKernel(const PathRequest& request) const
+{
+	return !LevelPolicy.SupportsPreprocessing() || (request.mSearchMode != SEARCH_JPS && request.mSearchMode != SEARCH_JPS_PLUS);
+}
+
+//the compiled search that begins the request, and continues it if UsesKernel
+const SearchKernelFunctions& Pathfinder::KernelOf(const PathRequest& request) const
+{
+	if (request.mSearchMode == SEARCH_BIDIRECTIONAL || request.mSearchMode == SEARCH_BIDIRECTIONAL_PARALLEL)
+		return Bidirectional;
+	return UsesKernel(request) ? Kernel : HeapKernel;
+}
+
+//jump point search successors, instead of the surrounding nodes only the next jump point in every
+//direction that isnt pruned gets opened, the nodes skipped in between are filled back in by ConstructPath
+template <class Cost>
+void Pathfinder::JumpPoints(SearchContext& context, int iCurrentCell, const glm::ivec2& ivTargetPos, bool bJumpTable) const
+{
+	glm::ivec2 ivCurrentPos = Grid.Position(iCurrentCell);
+	typename Cost::Type G = context.SearchSpace.template Costs<typename Cost::Type>()[iCurrentCell];
+
+	//direction the current node was reached in, the start node has no parent
+	glm::ivec2 ivDelta(0);
+	if (context.SearchSpace.vecParent[iCurrentCell] != -1)
+		ivDelta = glm::sign(ivCurrentPos - Grid.Position(context.SearchSpace.vecParent[iCurrentCell]));
+
+	glm::ivec2 ivDirs[GridDirection::iCount];
+	int iDirs = JumpPointSearch::PrunedDirections(Grid, ivCurrentPos, ivDelta.x, ivDelta.y, ivDirs);
+	for (int i = 0; i < iDirs; i++)
+	{
+		int iJumpCell = bJumpTable ? JumpTable.Jump(Grid, iCurrentCell, GridDirection::FromDelta(ivDirs[i].x, ivDirs[i].y), ivTargetPos)
+			: JumpPointSearch::Jump(Grid, ivCurrentPos.x, ivCurrentPos.y, ivDirs[i].x, ivDirs[i].y, ivTargetPos);
+		if (iJumpCell == -1)
+			continue;
+
+		//every jump is a straight or diagonal line so the cost is the number of steps times the step cost
+		glm::ivec2 ivJumpPos = Grid.Position(iJumpCell);
+		int iSteps = glm::max(glm::abs(ivJumpPos.x - ivCurrentPos.x), glm::abs(ivJumpPos.y - ivCurrentPos.y));
+		typename Cost::Type StepCost = (ivDirs[i].x != 0 && ivDirs[i].y != 0) ? Cost::Diagonal : Cost::Straight;
+		OpenNode<Cost>(context, iJumpCell, ivJumpPos, G + static_cast<typename Cost::Type>(iSteps) * StepCost, iCurrentCell, ivTargetPos);
+	}
+}
+
+//adds the node to the openlist or updates it if it is already on it and was reached with a lower G
+template <class Cost>
+void Pathfinder::OpenNode(SearchContext& context, int iCell, const glm::ivec2& ivGridPos, typename Cost::Type G, int iParentCell, const glm::ivec2& ivTargetPos) const
+{
+	PathfindingHeap<typename Cost::Type>& openList = context.template OpenListOf<PathfindingHeap<typename Cost::Type>>();
+	typename Cost::Type H = SearchPolicies::Octile::Estimate<Cost>(glm::abs(ivGridPos.x - ivTargetPos.x), glm::abs(ivGridPos.y - ivTargetPos.y));
+	NodeState state = context.SearchSpace.State(iCell);
+	//first check if the neighbor is not in closed list
+	if (state == NODE_CLOSED)
+		return;
+
+	if (state == NODE_NONE)
+	{
+		//add it if it isnt in the openlist
+		context.SearchSpace.Open(iCell, G, iParentCell);
+		openList.Push(iCell, G + H, G);
+		SEARCH_STAT(context.Stats.iGenerated++);
+		SEARCH_STAT(context.Stats.iHeuristicCalls++);
+		SEARCH_STAT(context.Stats.iPeakOpen = glm::max(context.Stats.iPeakOpen, openList.Size()));
+	}
+	else if (G < context.SearchSpace.template Costs<typename Cost::Type>()[iCell])
+	{
+		//found a cheaper way to this node so update its parent and move it up the heap
+		context.SearchSpace.Open(iCell, G, iParentCell);
+		openList.DecreaseKey(iCell, G + H, G);
+		SEARCH_STAT(context.Stats.iReopened++);
+		SEARCH_STAT(context.Stats.iHeuristicCalls++);
+	}
+}
+
+//construct the path of a jump point search
+//has to be done as soon as the search finishes since the SearchSpace is reused by the next one
+template <class Cost>
+void Pathfinder::ConstructPath(SearchContext& context, PathResult& result, int iStartCell, int iTargetCell) const
+{
+	//construct path using reverse traversal of the parents
+	//with jump point search the parent can be several tiles away, the tiles in between are stepped through
+	//so that the path still has every tile on it for PathFollowingSystem
+	std::vector<typename Cost::Type>& vecG = context.SearchSpace.template Costs<typename Cost::Type>();
+	result.fCost = Cost::ToFloat(vecG[iTargetCell]);
+
+	int iCell = iTargetCell;
+	while (iCell != iStartCell)
+	{
+		int iParentCell = context.SearchSpace.vecParent[iCell];
+		glm::ivec2 ivGridPos = Grid.Position(iCell), ivParentPos = Grid.Position(iParentCell);
+		glm::ivec2 ivStep = glm::sign(ivParentPos - ivGridPos);
+		typename Cost::Type G = vecG[iCell], StepCost = (ivStep.x != 0 && ivStep.y != 0) ? Cost::Diagonal : Cost::Straight;
+		for (; ivGridPos != ivParentPos; ivGridPos += ivStep, G -= StepCost)
+			result.vecPath.push_back(PathfindingNode(ivGridPos, Cost::ToFloat(G)));
+		iCell = iParentCell;
+	}
+
+	//keep what the search looked at so it can be displayed, the buffers are swapped rather than copied
+	if (context.SearchSpace.bRecordVisited)
+		std::swap(result.vecVisitedCells, context.SearchSpace.vecVisited);
+}
@@ -0,0 +1,270 @@
+//the a* engine, a grid and the queries on it without any rendering or ecs
+//used by AStarPathfindingSystem in the SDL app and on its own by the headless tools
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm.hpp>
+#include <spdlog/logger.h>
+#include <spdlog/sinks/ringbuffer_sink.h>
+#include "PathfindingNode.h"
+#include "PathfindingGrid.h"
+#include "PathfindingHeap.h"
+#include "JumpPointSearch.h"
+#include "HierarchicalGraph.h"
+#include "LandmarkTable.h"
+#include "GoalDistanceField.h"
+#include "DStarLite.h"
+#include "CooperativePlanner.h"
+#include "ConnectedRegions.h"
+#include "SearchContext.h"
+#include "SearchKernel.h"
+#include "BidirectionalSearch.h"
+#include "SearchStats.h"
+#include "PathfindingWorkers.h"
+#include "BackgroundBuild.h"
+
+//queries run on the PathfindingWorkers once StartWorkers was called, time sliced over several calls of Update once
+//SetSearchBudget was called, otherwise right away in Submit, D* Lite plans are always time sliced on the calling thread
+//either way the results come out of Update, FindPath is the blocking query for tools that dont need any of that
+class Pathfinder
+{
+	//a search that is continued every Update until it is done, owns its context for as long as it runs, a D* Lite plan
+	//has none since the planner of the agent keeps everything
+	struct SlicedSearch
+	{
+		PathRequest request;
+		std::unique_ptr<SearchContext> context;
+		PathResult result;
+		SlicedSearch(const PathRequest& request, std::unique_ptr<SearchContext> context) :
+			request(request), context(std::move(context)), result(request.query.iAgent, request.iRequestID) {}
+	};
+
+	//finished searches waiting to be taken by Update
+	std::vector<PathResult> vecReadyResults;
+	//results taken from the workers, kept around so its capacity is reused every frame
+	std::vector<PathResult> vecWorkerResults;
+	//used by searches on the calling thread and to refine lazy paths
+	SearchContext MainContext;
+	PathfindingWorkers Workers;
+	std::vector<SlicedSearch> vecSlicedSearches;
+	//contexts of finished sliced searches, reused by the next ones
+	std::vector<std::unique_ptr<SearchContext>> vecFreeContexts;
+	//per frame limits of the sliced searches, 0 is no limit and both 0 turns time slicing off
+	int iExpansionBudget, iMicrosecondBudget;
+	//emptied results that were used or dropped, their buffers are reused by the next searches on the calling thread
+	std::vector<PathResult> vecSpareResults;
+	//keep what every search visited for display, off in production mode
+	bool bVisualize;
+	//round robin position in vecSlicedSearches
+	std::size_t iNextSlicedSearch;
+	//expansions a search gets before the next one of the same priority has its turn
+	const int iSliceExpansions = 64;
+	//newest request of every agent still waiting for its result, anything older that finishes after it is dropped
+	//agents keep their entry once their result is in, so only an agent that was never seen before allocates
+	std::unordered_map<std::uint32_t, std::uint32_t> mapLatestRequests;
+	std::uint32_t iNextRequestID;
+	//changes whenever the level does, anything found on an older one can be out of date
+	std::uint32_t iLevelGeneration;
+	//records of every finished search until TakeStats, only kept while bCollectStats is set
+	std::vector<SearchStats> vecStats, vecWorkerStats;
+	bool bCollectStats;
+	//the last records as text, for when nobody is polling TakeStats and a slow frame has to be explained afterwards
+	std::shared_ptr<spdlog::sinks::ringbuffer_sink_mt> StatsSink;
+	std::shared_ptr<spdlog::logger> StatsLog;
+	//all valid path nodes are marked walkable here
+	PathfindingGrid Grid;
+	//path nodes inserted while the level is loading, moved into the Grid once its dimensions are known
+	std::vector<glm::ivec2> vecPendingNodes;
+	//connected components of the Grid, start and target in different ones means there is no path
+	ConnectedRegions Regions;
+	SearchMode mSearchMode;
+	//precomputed jump distances for SEARCH_JPS_PLUS, only built when bJumpPointTable is set
+	JumpPointTable JumpTable;
+	bool bJumpPointTable;
+	//distances to iLandmarks landmark cells, only built for levels with HEURISTIC_LANDMARKS
+	LandmarkTable Landmarks;
+	int iLandmarks;
+	//bumped whenever Landmarks is cleared or replaced, a sliced search that began on an older table starts over
+	std::uint32_t iLandmarkGeneration;
+	//an opened tile can make the landmark bounds overestimate, they are dropped and built again into RebuiltLandmarks
+	//off the frame while the searches go on with octile alone, bLandmarksStale is a tile that opened after the running
+	//build copied the grid
+	LandmarkTable RebuiltLandmarks;
+	BackgroundBuild LandmarkBuild;
+	bool bLandmarksStale;
+	//costs to the goals asked for with GetGoalDistanceField, a SEARCH_FLOW_FIELD query to one of them is answered by
+	//walking down its field
+	GoalDistanceFieldCache GoalFields;
+	//a changed tile marks every field stale and they are built again into vecRebuiltFields off the frame, one for every
+	//goal of vecFieldGoals, bFieldsStale is a tile that changed after the running build copied the grid
+	std::vector<glm::ivec2> vecFieldGoals;
+	std::vector<GoalDistanceField> vecRebuiltFields;
+	BackgroundBuild FieldBuild;
+	bool bFieldsStale;
+	//the plans of SEARCH_DSTAR_LITE by agent, repaired by the next query of the agent and by SetWalkable, 13 bytes per
+	//cell each so at most iPlannerCapacity are kept and the least recently used one is handed to the next agent
+	struct Planner
+	{
+		std::unique_ptr<DStarLite> planner;
+		std::uint64_t iLastUse;
+	};
+	std::unordered_map<std::uint32_t, Planner> mapPlanners;
+	std::size_t iPlannerCapacity;
+	std::uint64_t iPlannerUses;
+	//expansions a frame of the D* Lite plans when SetSearchBudget wasnt called
+	const int iPlannerExpansions = 2000;
+	//a target that moves further than this many tiles is planned from scratch
+	int iRepairRadius;
+	//agents moved a tick at a time on space time plans that keep clear of each other
+	CooperativePlanner Cooperative;
+	//clusters and entrances for SEARCH_HPA, only built when iClusterSize isnt 0
+	HierarchicalGraph Hierarchy;
+	int iClusterSize;
+	//the policy for the next level and the one the current level was built with
+	SearchPolicy Policy, LevelPolicy;
+	//the plain search compiled for LevelPolicy, the same with the heap whose Begin jump point searches start with
+	//and the bidirectional search and the flood of the goal distance fields on the same policies
+	SearchKernelFunctions Kernel, HeapKernel, Bidirectional, GoalFlood;
+	//lazily refined paths are topped up until the agent has this many tiles left to walk
+	const std::size_t iRefineLookahead = 8;
+
+	void BuildHierarchy();
+	void BuildJumpPointTable();
+	void BuildLandmarks();
+	void StartLandmarkBuild();
+	void ProcessBackgroundBuilds();
+	void CancelBackgroundBuilds();
+	const GoalDistanceField* BuildGoalDistanceField(const glm::ivec2& ivGoalPos, bool bPinned);
+	void RefreshGoalDistanceFields();
+	void StartGoalFieldBuild();
+
+	bool FindPath(const PathRequest& request, SearchContext& context, PathResult& result) const;
+	bool Replan(const PathRequest& request, PathResult& result);
+	SearchStatus BeginReplan(const PathRequest& request, PathResult& result);
+	SearchStatus ContinueReplan(const PathRequest& request, PathResult& result, int iMaxExpansions);
+	DStarLite& PlannerOf(std::uint32_t iAgent);
+	SearchStatus BeginSearch(const PathRequest& request, SearchContext& context, PathResult& result) const;
+	SearchStatus ContinueSearch(const PathRequest& request, SearchContext& context, PathResult& result, int iMaxExpansions) const;
+	template <class Cost> SearchStatus ContinueJumpPoints(const PathRequest& request, SearchContext& context, PathResult& result, int iMaxExpansions) const;
+	bool FindHierarchical(const PathQuery& query, SearchContext& context, PathResult& result) const;
+	void RefineWaypoint(SearchContext& context, std::vector<PathfindingNode>& vecPath, std::vector<glm::ivec2>& vecWaypoints) const;
+	void CountSegmentCosts(const glm::ivec2& ivFromPos, float fFromCost, std::vector<PathfindingNode>::iterator itBegin, std::vector<PathfindingNode>::iterator itEnd) const;
+	float Heuristic(const glm::ivec2& ivCurrentPos, const glm::ivec2& ivTargetPos) const;
+	bool UsesKernel(const PathRequest& request) const;
+	const SearchKernelFunctions& KernelOf(const PathRequest& request) const;
+	template <class Cost> void JumpPoints(SearchContext& context, int iCurrentCell, const glm::ivec2& ivTargetPos, bool bJumpTable) const;
+	template <class Cost> void OpenNode(SearchContext& context, int iCell, const glm::ivec2& ivGridPos, typename Cost::Type G, int iParentCell, const glm::ivec2& ivTargetPos) const;
+	template <class Cost> void ConstructPath(SearchContext& context, PathResult& result, int iStartCell, int iTargetCell) const;
+	void FinishStats(SearchContext& context, PathResult& result, SearchStatus status) const;
+	void RecordStats(const SearchStats& stats);
+
+	void StartSlicedSearch(const PathRequest& request);
+	void FinishSlicedSearch(std::size_t iSearch, SearchStatus status);
+	void ProcessSlicedSearches();
+
+	void TakeSpareBuffers(PathResult& result);
+	//keeps the result for Update unless a newer request of the agent replaced it
+	void ReceiveResult(PathResult& result);
+
+public:
+	Pathfinder();
+
+	void InsertNode(glm::ivec2 ivGridPos);
+	//called once the level is loaded and its dimensions are known
+	void BuildGrid(int iWidth, int iHeight);
+	//changes a single tile once the level is loaded, the regions are updated in place
+	void SetWalkable(const glm::ivec2& ivGridPos, bool bWalkable);
+	//drops the level and every query still pending on it
+	void Clear();
+	const PathfindingGrid& GetGrid() const { return Grid; }
+	//whether there can be a path between the two tiles at all, two reads of the connected regions
+	bool Connected(const glm::ivec2& ivPosA, const glm::ivec2& ivPosB) const
+	{
+		return Grid.IsWalkable(ivPosA) && Grid.IsWalkable(ivPosB) && Regions.Connected(Grid.Index(ivPosA), Grid.Index(ivPosB));
+	}
+	//bumped by BuildGrid, SetWalkable and Clear, paths kept by the caller are only valid on the generation they were found on
+	std::uint32_t GetLevelGeneration() const { return iLevelGeneration; }
+
+	//runs the searches on iThreads worker threads, every one of them gets its own SearchContext
+	void StartWorkers(int iThreads);
+	//caps the work searches on the calling thread do per Update, the rest is continued next time
+	//iExpansions nodes or iMicroseconds, whichever comes first, 0 leaves that limit out and both 0 runs every search at once
+	void SetSearchBudget(int iExpansions, int iMicroseconds);
+	//production mode turns this off, the searches then keep nothing but the parents they need to build the path
+	void SetVisualization(bool bVisualize) { this->bVisualize = bVisualize; }
+	bool GetVisualization() const { return bVisualize; }
+	//HPA* cluster size in tiles, 0 turns the hierarchy off
+	void SetHierarchicalClusterSize(int iClusterSize) { this->iClusterSize = iClusterSize; }
+	//landmarks of levels with HEURISTIC_LANDMARKS, every one costs 2 bytes per cell, 4 on levels too large for 16 bit
+	//distances, and a dijkstra over the level at load
+	void SetLandmarkCount(int iLandmarks) { this->iLandmarks = iLandmarks; }
+	//targets of SEARCH_DSTAR_LITE that move at most this many tiles repair the last plan, further ones start over
+	void SetRepairRadius(int iRepairRadius) { this->iRepairRadius = iRepairRadius; }
+	//drops the D* Lite plan of an agent that is gone or got where it was going
+	void DropPlanner(std::uint32_t iAgent) { mapPlanners.erase(iAgent); }
+	//D* Lite plans kept before the least recently used one is taken over by another agent, 16 by default
+	void SetPlannerCapacity(std::size_t iCapacity);
+	//unpinned goal distance fields kept before the least recently used is dropped, 8 by default
+	void SetGoalFieldCapacity(std::size_t iCapacity);
+	//the JPS+ preprocessing, costs 16 bytes per cell so it is optional and decided per level
+	void SetJumpPointPreprocessing(bool bJumpPointTable) { this->bJumpPointTable = bJumpPointTable; }
+	void SetSearchMode(SearchMode mSearchMode) { this->mSearchMode = mSearchMode; }
+	SearchMode GetSearchMode() const { return mSearchMode; }
+	//connectivity, corner cutting, heuristic and cost type, takes effect with the next BuildGrid
+	//the preprocessing of JPS+ and HPA* is only built if the policy supports it
+	void SetSearchPolicy(const SearchPolicy& Policy) { this->Policy = Policy; }
+	//the policy the next level gets, and the one the current level was built with
+	const SearchPolicy& GetSearchPolicy() const { return Policy; }
+	const SearchPolicy& GetLevelSearchPolicy() const { return LevelPolicy; }
+
+	//the cost from every tile to the goal, built on the first call for that goal and cached, while it is cached
+	//SEARCH_FLOW_FIELD queries to the goal walk down the field instead of searching
+	//a changed tile makes every field Stale until it is built again off the frame, a pinned field, the one goal every
+	//agent of the level heads for, is never dropped for another one, nullptr if the goal isnt walkable
+	const GoalDistanceField* GetGoalDistanceField(const glm::ivec2& ivGoalPos, bool bPinned = false);
+	//the cached field of the goal without building it, nullptr if there is none
+	const GoalDistanceField* FindGoalDistanceField(const glm::ivec2& ivGoalPos) const;
+	//GetGoalDistanceField that keeps the field like a pinned one until every hold on it is released, for agents that
+	//look the field up at every step, a field whose goal is walled is dropped with its holds
+	const GoalDistanceField* HoldGoalDistanceField(const glm::ivec2& ivGoalPos);
+	void ReleaseGoalDistanceField(const glm::ivec2& ivGoalPos);
+
+	//agents planned together with WHCA* so they dont walk through each other, they are added on the cell they stand on
+	//and given goals on the planner and then moved a tick at a time by StepCooperativeAgents
+	//every goal gets a goal distance field, with more distinct goals than SetGoalFieldCapacity keeps they are built again
+	//and again, the agents are dropped with the level
+	CooperativePlanner& GetCooperativePlanner() { return Cooperative; }
+	const CooperativePlanner& GetCooperativePlanner() const { return Cooperative; }
+	//plans the agents that are due within the plan budget and moves all of them on to the next tick
+	void StepCooperativeAgents();
+
+	//starts a query with the current search mode and returns its request id
+	std::uint32_t Submit(const PathQuery& query);
+	//a query the caller answers itself, from a PathCache, the result gets a new request id of the agent so the results
+	//of its older requests are dropped, and the buffers of a recycled result so filling it doesnt allocate
+	void Supersede(std::uint32_t iAgent, PathResult& result);
+	//runs this frames share of the sliced searches and appends every result that finished since the last call
+	//only the newest request of every agent gets a result, and only if a path was found
+	void Update(std::vector<PathResult>& vecResults);
+	//blocks until every query submitted so far is done, their results come out of the next Update
+	//and until the level data rebuilt after SetWalkable is in
+	void Wait();
+	//searches right away on the calling thread, false if there is no path
+	bool FindPath(const PathQuery& query, PathResult& result);
+	//refines lazy hierarchical paths until the agent has enough tiles ahead of it
+	void RefinePath(std::vector<PathfindingNode>& vecPath, std::vector<glm::ivec2>& vecWaypoints);
+	//the result has been used, its buffers go back to whoever runs the searches so they dont allocate
+	void Recycle(PathResult& result);
+
+	//SearchStats of every search that finished, failed ones included, nothing is counted unless PATHFINDING_STATS is on
+	void SetStatsCollection(bool bCollectStats);
+	//moves the records collected since the last call into vecOut
+	void TakeStats(std::vector<SearchStats>& vecOut);
+	//streams every record as a line of text into a ringbuffer_sink that keeps the last iRecords of them
+	void EnableStatsLog(std::size_t iRecords);
+	//the newest iRecords lines of the stats log, oldest first, 0 is all of them
+	std::vector<std::string> GetStatsLog(std::size_t iRecords = 0) const;
+};
@@ -0,0 +1,143 @@
+//monotone bucket queue, the openlist of integer cost searches whose F never drops below the F popped last
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//one bucket per F on a ring that covers every F the openlist can hold at once, which SearchPolicy::BucketSpan gives
+//pushing is appending to the bucket of its F and popping moves a cursor up to the next bucket with anything in it
+//the bucket under the cursor is sorted by G so the entry with the largest G is popped first, the same tie break as
+//PathfindingHeap, a bucket is only sorted once the cursor gets to it, everything pushed into it after that is a
+//successor of the node just popped with the same F and so a larger G than anything left, it goes on top after a compare
+//or two with the other successors
+//a decreased key is pushed again and the old entry is skipped once it comes up, vecKeys tells which one is current
+class PathfindingBucketQueue
+{
+public:
+	struct Entry
+	{
+		//index of the cell on the PathfindingGrid
+		int iCell;
+		std::int32_t F, G;
+	};
+
+private:
+	std::vector<std::vector<Entry>> vecBuckets;
+	//ring size - 1, the ring is a power of two
+	std::int32_t iMask = 0;
+	//cell -> F of its current entry, only valid while the cell is on the queue
+	std::vector<std::int32_t> vecKeys;
+	//F of the bucket the cursor is on, nothing on the queue is below it
+	std::int32_t iCursor = 0;
+	//the bucket at the cursor is sorted by G
+	bool bCursorSorted = false;
+	//cells on the queue, the skipped entries arent counted
+	std::size_t iSize = 0;
+
+	static bool LessG(const Entry& a, const Entry& b)
+	{
+		return a.G < b.G;
+	}
+
+	void MoveCursor(std::int32_t F)
+	{
+		iCursor = F;
+		bCursorSorted = false;
+	}
+
+	void Insert(int iCell, std::int32_t F, std::int32_t G)
+	{
+		vecKeys[iCell] = F;
+		if (iSize == 0 || F < iCursor)
+			MoveCursor(F);
+		std::vector<Entry>& vecBucket = vecBuckets[F & iMask];
+		vecBucket.push_back(Entry{ iCell, F, G });
+		//a decreased key can land below the top of the sorted bucket
+		if (F == iCursor && bCursorSorted)
+			for (std::size_t iSlot = vecBucket.size() - 1; iSlot > 0 && vecBucket[iSlot - 1].G > G; iSlot--)
+				std::swap(vecBucket[iSlot - 1], vecBucket[iSlot]);
+	}
+
+public:
+	//number of cells on the grid and how far apart the F on the queue can be at most, 0 cells frees it
+	void Resize(int iCells, int iSpan)
+	{
+		std::size_t iRing = 1;
+		while (iCells > 0 && iRing < static_cast<std::size_t>(iSpan))
+			iRing *= 2;
+		std::vector<std::vector<Entry>>(iCells > 0 ? iRing : 0).swap(vecBuckets);
+		iMask = static_cast<std::int32_t>(iRing) - 1;
+		vecKeys.assign(iCells, -1);
+		MoveCursor(0);
+		iSize = 0;
+	}
+
+	bool Empty() const { return iSize == 0; }
+	std::size_t Size() const { return iSize; }
+
+	//the buckets keep their capacity so a warmed up queue doesnt allocate
+	void Clear()
+	{
+		for (auto& vecBucket : vecBuckets)
+			vecBucket.clear();
+		bCursorSorted = false;
+		iSize = 0;
+	}
+
+	void Push(int iCell, std::int32_t F, std::int32_t G)
+	{
+		Insert(iCell, F, G);
+		iSize++;
+	}
+
+	//the entry Pop would return, the replaced entries and empty buckets before it are dropped on the way
+	const Entry& Top()
+	{
+		while (true)
+		{
+			std::vector<Entry>& vecBucket = vecBuckets[iCursor & iMask];
+			//an entry of a later F on the same ring slot is never there, the span is smaller than the ring
+			if (vecBucket.empty())
+			{
+				MoveCursor(iCursor + 1);
+				continue;
+			}
+			if (!bCursorSorted)
+			{
+				std::sort(vecBucket.begin(), vecBucket.end(), LessG);
+				bCursorSorted = true;
+			}
+			//F only goes down when a key is decreased, an entry with another F than the cell has now was replaced
+			if (vecKeys[vecBucket.back().iCell] != vecBucket.back().F)
+			{
+				vecBucket.pop_back();
+				continue;
+			}
+			return vecBucket.back();
+		}
+	}
+
+	//removes and returns the entry with the least F, of those the one with the largest G
+	Entry Pop()
+	{
+		Entry entry = Top();
+		vecBuckets[iCursor & iMask].pop_back();
+		vecKeys[entry.iCell] = -1;
+		iSize--;
+		return entry;
+	}
+
+	//the cell is already on the queue and was reached with a lower cost
+	void DecreaseKey(int iCell, std::int32_t F, std::int32_t G)
+	{
+		Insert(iCell, F, G);
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		std::size_t iBytes = vecKeys.size() * sizeof(std::int32_t) + vecBuckets.size() * sizeof(std::vector<Entry>);
+		for (auto& vecBucket : vecBuckets)
+			iBytes += vecBucket.capacity() * sizeof(Entry);
+		return iBytes;
+	}
+};
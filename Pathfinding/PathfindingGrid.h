@@ -0,0 +1,166 @@
+//dense storage of the level for the pathfinding system
+//every cell is addressed by its index y * width + x instead of a tree lookup on PathfindingNode
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+
+//the 8 directions a node can be reached from
+//first 4 are top bottom right left and rest are the diagonal ones, same order Neighbors() always used
+namespace GridDirection
+{
+	constexpr int iCount = 8;
+	constexpr int iX[iCount] = { 0, 0, 1, -1, -1, 1, -1, 1 };
+	constexpr int iY[iCount] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+
+	inline bool IsDiagonal(int iDir) { return iDir >= 4; }
+
+	//index of the direction with that step or -1 for (0, 0)
+	inline int FromDelta(int iDX, int iDY)
+	{
+		for (int iDir = 0; iDir < iCount; iDir++)
+			if (iX[iDir] == iDX && iY[iDir] == iDY)
+				return iDir;
+		return -1;
+	}
+};
+
+//static part of the level, which cells can be walked on
+class PathfindingGrid
+{
+	int iWidth, iHeight;
+	//one bit per cell, set if the tile is a path tile
+	std::vector<std::uint64_t> vecWalkable;
+
+public:
+	PathfindingGrid() : iWidth(0), iHeight(0) {}
+
+	//resizes the grid and marks every cell as an obstacle
+	void Resize(int iWidth, int iHeight)
+	{
+		this->iWidth = iWidth;
+		this->iHeight = iHeight;
+		vecWalkable.assign((static_cast<std::size_t>(iWidth) * iHeight + 63) / 64, 0);
+	}
+
+	void Clear()
+	{
+		Resize(0, 0);
+	}
+
+	int Width() const { return iWidth; }
+	int Height() const { return iHeight; }
+	int Size() const { return iWidth * iHeight; }
+
+	bool InBounds(int iX, int iY) const
+	{
+		return iX >= 0 && iY >= 0 && iX < iWidth && iY < iHeight;
+	}
+
+	int Index(int iX, int iY) const { return iY * iWidth + iX; }
+	int Index(const glm::ivec2& ivGridPos) const { return Index(ivGridPos.x, ivGridPos.y); }
+	glm::ivec2 Position(int iCell) const { return glm::ivec2(iCell % iWidth, iCell / iWidth); }
+
+	void SetWalkable(const glm::ivec2& ivGridPos, bool bWalkable)
+	{
+		if (!InBounds(ivGridPos.x, ivGridPos.y))
+			return;
+		int iCell = Index(ivGridPos);
+		if (bWalkable)
+			vecWalkable[iCell >> 6] |= (std::uint64_t(1) << (iCell & 63));
+		else
+			vecWalkable[iCell >> 6] &= ~(std::uint64_t(1) << (iCell & 63));
+	}
+
+	//anything outside the map is an obstacle
+	bool IsWalkable(int iX, int iY) const
+	{
+		if (!InBounds(iX, iY))
+			return false;
+		int iCell = Index(iX, iY);
+		return (vecWalkable[iCell >> 6] >> (iCell & 63)) & 1;
+	}
+	bool IsWalkable(const glm::ivec2& ivGridPos) const { return IsWalkable(ivGridPos.x, ivGridPos.y); }
+
+	std::size_t MemoryUsage() const { return vecWalkable.size() * sizeof(std::uint64_t); }
+};
+
+
+enum NodeState : std::uint8_t { NODE_NONE, NODE_OPEN, NODE_CLOSED };
+
+//per search data of every cell, stored in parallel arrays indexed the same way as the grid
+//every cell is stamped with the generation of the search that last wrote it, so anything with an older
+//stamp is treated as untouched and starting a new search only has to bump the generation
+struct PathfindingSearchSpace
+{
+	std::vector<float> vecG;
+	//G of searches with integer costs, only allocated for levels that use them
+	std::vector<std::int32_t> vecIntG;
+	//cell the node was reached from, -1 for the start node
+	std::vector<std::int32_t> vecParent;
+	std::vector<std::uint8_t> vecState;
+	std::vector<std::uint32_t> vecGeneration;
+	std::uint32_t iGeneration = 0;
+	//cells opened since the last Reset, only kept while bRecordVisited is set since it is just for displaying the search
+	//every closed cell was opened first so this is everything the search looked at
+	std::vector<std::int32_t> vecVisited;
+	bool bRecordVisited = false;
+
+	void Resize(int iSize, bool bIntegerCosts = false)
+	{
+		vecG.assign(iSize, 0.0f);
+		if (bIntegerCosts)
+			vecIntG.assign(iSize, 0);
+		else
+			std::vector<std::int32_t>().swap(vecIntG);
+		vecParent.assign(iSize, -1);
+		vecState.assign(iSize, NODE_NONE);
+		vecGeneration.assign(iSize, 0);
+		iGeneration = 0;
+	}
+
+	//invalidates everything from the previous search
+	void Reset()
+	{
+		vecVisited.clear();
+		if (++iGeneration == 0)
+		{
+			//the counter wrapped around so old stamps could look current, clear them once
+			std::fill(vecGeneration.begin(), vecGeneration.end(), 0);
+			iGeneration = 1;
+		}
+	}
+
+	NodeState State(int iCell) const
+	{
+		return vecGeneration[iCell] == iGeneration ? static_cast<NodeState>(vecState[iCell]) : NODE_NONE;
+	}
+
+	//the G array of the cost type
+	template <typename Cost> std::vector<Cost>& Costs();
+
+	template <typename Cost>
+	void Open(int iCell, Cost G, int iParentCell)
+	{
+		if (bRecordVisited && vecGeneration[iCell] != iGeneration)
+			vecVisited.push_back(iCell);
+		vecGeneration[iCell] = iGeneration;
+		vecState[iCell] = NODE_OPEN;
+		Costs<Cost>()[iCell] = G;
+		vecParent[iCell] = iParentCell;
+	}
+
+	void Close(int iCell)
+	{
+		vecState[iCell] = NODE_CLOSED;
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecG.size() * (sizeof(float) + sizeof(std::int32_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t)) + vecIntG.size() * sizeof(std::int32_t);
+	}
+};
+
+template <> inline std::vector<float>& PathfindingSearchSpace::Costs<float>() { return vecG; }
+template <> inline std::vector<std::int32_t>& PathfindingSearchSpace::Costs<std::int32_t>() { return vecIntG; }
@@ -0,0 +1,149 @@
+//indexed binary min heap used as the openlist of the a* search
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//nodes are ordered by F and ties are broken in favour of the larger G since that node is closer to the target
+//every cell keeps a handle to its slot in the heap so finding it and decreasing its key doesnt need a scan
+//Cost is float or the integer fixed point costs of SearchKernel
+template <typename Cost = float>
+class PathfindingHeap
+{
+public:
+	struct Entry
+	{
+		//index of the cell on the PathfindingGrid
+		int iCell;
+		Cost F, G;
+	};
+
+private:
+	std::vector<Entry> vecEntries;
+	//cell -> slot of the entry in vecEntries, only valid while the cell is on the heap
+	std::vector<std::int32_t> vecHandles;
+
+	static bool Less(const Entry& a, const Entry& b)
+	{
+		if (a.F != b.F)
+			return a.F < b.F;
+		return a.G > b.G;
+	}
+
+	void Place(std::size_t iSlot, const Entry& entry)
+	{
+		vecEntries[iSlot] = entry;
+		vecHandles[entry.iCell] = static_cast<std::int32_t>(iSlot);
+	}
+
+	void SiftUp(std::size_t iSlot)
+	{
+		Entry entry = vecEntries[iSlot];
+		while (iSlot > 0)
+		{
+			std::size_t iParent = (iSlot - 1) / 2;
+			if (!Less(entry, vecEntries[iParent]))
+				break;
+			Place(iSlot, vecEntries[iParent]);
+			iSlot = iParent;
+		}
+		Place(iSlot, entry);
+	}
+
+	void SiftDown(std::size_t iSlot)
+	{
+		Entry entry = vecEntries[iSlot];
+		std::size_t iSize = vecEntries.size();
+		while (true)
+		{
+			std::size_t iChild = 2 * iSlot + 1;
+			if (iChild >= iSize)
+				break;
+			if (iChild + 1 < iSize && Less(vecEntries[iChild + 1], vecEntries[iChild]))
+				iChild++;
+			if (!Less(vecEntries[iChild], entry))
+				break;
+			Place(iSlot, vecEntries[iChild]);
+			iSlot = iChild;
+		}
+		Place(iSlot, entry);
+	}
+
+public:
+	//number of cells on the grid, handles are indexed by cell
+	void Resize(int iCells)
+	{
+		vecEntries.clear();
+		vecHandles.assign(iCells, -1);
+	}
+
+	bool Empty() const { return vecEntries.empty(); }
+	std::size_t Size() const { return vecEntries.size(); }
+
+	typename std::vector<Entry>::const_iterator begin() const { return vecEntries.begin(); }
+	typename std::vector<Entry>::const_iterator end() const { return vecEntries.end(); }
+
+	void Clear()
+	{
+		vecEntries.clear();
+	}
+
+	void Push(int iCell, Cost F, Cost G)
+	{
+		vecEntries.push_back(Entry{ iCell, F, G });
+		SiftUp(vecEntries.size() - 1);
+	}
+
+	//the entry Pop would return
+	const Entry& Top() const { return vecEntries.front(); }
+
+	//removes and returns the entry with the least F
+	Entry Pop()
+	{
+		Entry entryMin = vecEntries.front();
+		Entry entryLast = vecEntries.back();
+		vecEntries.pop_back();
+		if (!vecEntries.empty())
+		{
+			vecEntries.front() = entryLast;
+			SiftDown(0);
+		}
+		return entryMin;
+	}
+
+	//the cell is already on the heap and was reached with a lower cost
+	void DecreaseKey(int iCell, Cost F, Cost G)
+	{
+		std::size_t iSlot = vecHandles[iCell];
+		vecEntries[iSlot].F = F;
+		vecEntries[iSlot].G = G;
+		SiftUp(iSlot);
+	}
+
+	//the cell is on the heap, its key goes either way
+	void Update(int iCell, Cost F, Cost G)
+	{
+		std::size_t iSlot = vecHandles[iCell];
+		vecEntries[iSlot].F = F;
+		vecEntries[iSlot].G = G;
+		SiftUp(iSlot);
+		SiftDown(vecHandles[iCell]);
+	}
+
+	//the cell is on the heap and is taken off it, the last entry fills its slot
+	void Remove(int iCell)
+	{
+		std::size_t iSlot = vecHandles[iCell];
+		Entry entryLast = vecEntries.back();
+		vecEntries.pop_back();
+		if (iSlot == vecEntries.size())
+			return;
+		Place(iSlot, entryLast);
+		SiftUp(iSlot);
+		SiftDown(vecHandles[entryLast.iCell]);
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecHandles.size() * sizeof(std::int32_t) + vecEntries.capacity() * sizeof(Entry);
+	}
+};
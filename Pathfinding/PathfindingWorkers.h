@@ -0,0 +1,207 @@
+//pool of worker threads that run path requests off the main thread
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SearchContext.h"
+
+//every worker has its own SearchContext, the level data is shared and only read while requests are in flight
+//so anything that changes the level has to call Pause, Wait or Cancel first
+class PathfindingWorkers
+{
+public:
+	//runs one search, returns false if there is no path
+	typedef std::function<bool(const PathRequest&, SearchContext&, PathResult&)> SearchFunction;
+
+private:
+	std::vector<std::thread> vecThreads;
+	std::vector<std::unique_ptr<SearchContext>> vecContexts;
+	//requests in the order they came in, the ones before iNextRequest are taken
+	//both are reset once every request is taken so the vector keeps its capacity instead of allocating
+	std::vector<PathRequest> vecRequests;
+	std::size_t iNextRequest;
+	std::vector<PathResult> vecResults;
+	//records of every search, failed ones included, only kept with PATHFINDING_STATS
+	std::vector<SearchStats> vecStats;
+	//emptied results the main thread is done with and failed ones, their buffers go to the next results
+	std::vector<PathResult> vecSpareResults;
+	std::mutex mutex;
+	//signals new requests to the workers and finished ones to Wait
+	std::condition_variable cvRequest, cvIdle;
+	int iBusy;
+	bool bStop, bPaused;
+	SearchFunction fnSearch;
+
+	void Work(SearchContext& context)
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cvRequest.wait(lock, [this]() { return bStop || (!bPaused && Pending()); });
+			if (bStop)
+				return;
+			PathRequest request = vecRequests[iNextRequest++];
+			if (!Pending())
+			{
+				vecRequests.clear();
+				iNextRequest = 0;
+			}
+			iBusy++;
+			PathResult result(request.query.iAgent, request.iRequestID);
+			if (!vecSpareResults.empty())
+			{
+				result.SwapBuffers(vecSpareResults.back());
+				vecSpareResults.pop_back();
+			}
+			lock.unlock();
+
+			bool bFound = fnSearch(request, context, result);
+
+			lock.lock();
+			SEARCH_STAT(vecStats.push_back(result.Stats));
+			if (bFound)
+				vecResults.push_back(std::move(result));
+			else
+				KeepBuffers(result);
+			iBusy--;
+			cvIdle.notify_all();
+		}
+	}
+
+	bool Pending() const { return iNextRequest < vecRequests.size(); }
+
+	//empties the result into the spare pool, the caller holds the lock
+	void KeepBuffers(PathResult& result)
+	{
+		if (result.Capacity() == 0)
+			return;
+		result.Clear();
+		vecSpareResults.emplace_back();
+		vecSpareResults.back().SwapBuffers(result);
+	}
+
+public:
+	PathfindingWorkers() : iNextRequest(0), iBusy(0), bStop(false), bPaused(false) {}
+
+	~PathfindingWorkers()
+	{
+		Stop();
+	}
+
+	bool Running() const { return !vecThreads.empty(); }
+
+	void Start(int iThreads, int iCells, const SearchPolicy& policy, SearchFunction fnSearch)
+	{
+		Stop();
+		this->fnSearch = fnSearch;
+		bStop = false;
+		for (int i = 0; i < iThreads; i++)
+		{
+			vecContexts.push_back(std::make_unique<SearchContext>());
+			vecContexts.back()->Resize(iCells, policy);
+		}
+		for (int i = 0; i < iThreads; i++)
+			vecThreads.emplace_back(&PathfindingWorkers::Work, this, std::ref(*vecContexts[i]));
+	}
+
+	//drops every request that hasnt started, lets the running ones finish and joins the threads
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bStop = true;
+			vecRequests.clear();
+			iNextRequest = 0;
+		}
+		cvRequest.notify_all();
+		for (auto& thread : vecThreads)
+			thread.join();
+		vecThreads.clear();
+		vecContexts.clear();
+		vecResults.clear();
+		vecStats.clear();
+		vecSpareResults.clear();
+	}
+
+	void Submit(const PathRequest& request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			vecRequests.push_back(request);
+		}
+		cvRequest.notify_one();
+	}
+
+	//moves every finished result into vecOut, called from the main thread
+	void TakeResults(std::vector<PathResult>& vecOut)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& result : vecResults)
+			vecOut.push_back(std::move(result));
+		vecResults.clear();
+	}
+
+	//moves the records of every search finished since the last call into vecOut
+	void TakeStats(std::vector<SearchStats>& vecOut)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& stats : vecStats)
+			vecOut.push_back(stats);
+		vecStats.clear();
+	}
+
+	//takes the buffers of a result back once it has been used
+	void Recycle(PathResult& result)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		KeepBuffers(result);
+	}
+
+	//blocks until every submitted request is done
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cvIdle.wait(lock, [this]() { return !Pending() && iBusy == 0; });
+	}
+
+	//waits for the running requests only and keeps the workers from starting the others until Resume, so the level can
+	//change without waiting for every request still in the queue, those then run on the changed level
+	void Pause()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		bPaused = true;
+		cvIdle.wait(lock, [this]() { return iBusy == 0; });
+	}
+
+	void Resume()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bPaused = false;
+		}
+		cvRequest.notify_all();
+	}
+
+	//drops the requests that havent started and the results nobody took, waits for the running ones
+	void Cancel()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		vecRequests.clear();
+		iNextRequest = 0;
+		cvIdle.wait(lock, [this]() { return iBusy == 0; });
+		vecResults.clear();
+	}
+
+	//the level changed size or policy, only safe once the workers are idle
+	void Resize(int iCells, const SearchPolicy& policy)
+	{
+		Wait();
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& context : vecContexts)
+			context->Resize(iCells, policy);
+	}
+};
@@ -0,0 +1,136 @@
+//which agent holds a cell at a tick, the space time reservations the cooperative planner plans around
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//a hash table of (cell, tick) keys with linear probing, kept at most half full
+//an entry is erased by moving the entries after it back into the gap, so there are no tombstones and a lookup stops at
+//the first empty slot however many reservations came and went before
+//most cells around an agent arent held at any tick, a count of held ticks per cell answers those without probing
+class ReservationTable
+{
+	struct Slot
+	{
+		std::uint64_t iKey;
+		std::uint32_t iAgent;
+	};
+	std::vector<Slot> vecSlots;
+	std::size_t iCount = 0, iMask = 0;
+	std::vector<std::uint16_t> vecHeldTicks;
+
+	static constexpr std::uint64_t iEmpty = ~std::uint64_t(0);
+
+	static std::uint64_t Key(int iCell, std::uint32_t iTick)
+	{
+		return (static_cast<std::uint64_t>(iTick) << 32) | static_cast<std::uint32_t>(iCell);
+	}
+
+	//neighboring cells and consecutive ticks of a cell differ in few bits, they are mixed so they dont cluster
+	std::size_t Home(std::uint64_t iKey) const
+	{
+		iKey ^= iKey >> 33;
+		iKey *= 0xFF51AFD7ED558CCDull;
+		iKey ^= iKey >> 33;
+		return static_cast<std::size_t>(iKey) & iMask;
+	}
+
+	//the slot of the key, or the empty slot it would go into
+	std::size_t Probe(std::uint64_t iKey) const
+	{
+		std::size_t iSlot = Home(iKey);
+		while (vecSlots[iSlot].iKey != iEmpty && vecSlots[iSlot].iKey != iKey)
+			iSlot = (iSlot + 1) & iMask;
+		return iSlot;
+	}
+
+	void Rehash(std::size_t iSlots)
+	{
+		std::vector<Slot> vecOld(iSlots, Slot{ iEmpty, iNobody });
+		vecOld.swap(vecSlots);
+		iMask = iSlots - 1;
+		for (auto& slot : vecOld)
+			if (slot.iKey != iEmpty)
+				vecSlots[Probe(slot.iKey)] = slot;
+	}
+
+public:
+	static constexpr std::uint32_t iNobody = 0xFFFFFFFF;
+
+	std::size_t Count() const { return iCount; }
+
+	//cells of the level, every reservation is dropped
+	void Resize(int iCells)
+	{
+		Clear();
+		vecHeldTicks.assign(iCells, 0);
+	}
+
+	//room for iEntries reservations without growing
+	void Presize(std::size_t iEntries)
+	{
+		std::size_t iSlots = 16;
+		while (iSlots < iEntries * 2)
+			iSlots *= 2;
+		if (iSlots > vecSlots.size())
+			Rehash(iSlots);
+	}
+
+	std::uint32_t Holder(int iCell, std::uint32_t iTick) const
+	{
+		if (vecHeldTicks[iCell] == 0)
+			return iNobody;
+		const Slot& slot = vecSlots[Probe(Key(iCell, iTick))];
+		return slot.iKey == iEmpty ? iNobody : slot.iAgent;
+	}
+
+	//the cell is the agents at the tick, false if another agent holds it already, that one keeps it
+	bool Hold(int iCell, std::uint32_t iTick, std::uint32_t iAgent)
+	{
+		if ((iCount + 1) * 2 > vecSlots.size())
+			Rehash(vecSlots.empty() ? 16 : vecSlots.size() * 2);
+		Slot& slot = vecSlots[Probe(Key(iCell, iTick))];
+		if (slot.iKey != iEmpty)
+			return slot.iAgent == iAgent;
+		iCount++;
+		vecHeldTicks[iCell]++;
+		slot = Slot{ Key(iCell, iTick), iAgent };
+		return true;
+	}
+
+	//only if the agent still holds it
+	void Release(int iCell, std::uint32_t iTick, std::uint32_t iAgent)
+	{
+		if (vecHeldTicks[iCell] == 0)
+			return;
+		std::size_t iGap = Probe(Key(iCell, iTick));
+		if (vecSlots[iGap].iKey == iEmpty || vecSlots[iGap].iAgent != iAgent)
+			return;
+		iCount--;
+		vecHeldTicks[iCell]--;
+		//every entry up to the next empty slot whose home isnt between the gap and itself moves back into the gap
+		for (std::size_t iSlot = (iGap + 1) & iMask; vecSlots[iSlot].iKey != iEmpty; iSlot = (iSlot + 1) & iMask)
+		{
+			std::size_t iHome = Home(vecSlots[iSlot].iKey);
+			if (((iSlot - iHome) & iMask) >= ((iSlot - iGap) & iMask))
+			{
+				vecSlots[iGap] = vecSlots[iSlot];
+				iGap = iSlot;
+			}
+		}
+		vecSlots[iGap].iKey = iEmpty;
+	}
+
+	void Clear()
+	{
+		for (auto& slot : vecSlots)
+			slot.iKey = iEmpty;
+		std::fill(vecHeldTicks.begin(), vecHeldTicks.end(), 0);
+		iCount = 0;
+	}
+
+	std::size_t MemoryUsage() const
+	{
+		return vecSlots.capacity() * sizeof(Slot) + vecHeldTicks.capacity() * sizeof(std::uint16_t);
+	}
+};
@@ -0,0 +1,193 @@
+//search modes, queries and results and the state a single search works in
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm.hpp>
+#include "PathfindingNode.h"
+#include "PathfindingGrid.h"
+#include "PathfindingHeap.h"
+#include "PathfindingBucketQueue.h"
+#include "HierarchicalGraph.h"
+#include "LandmarkTable.h"
+#include "SearchStats.h"
+#include "SearchPolicy.h"
+#include "SearchHelperThread.h"
+
+//SEARCH_JPS only opens jump points, it finds paths of the same cost as SEARCH_ASTAR with far fewer nodes on open maps
+//SEARCH_JPS_PLUS is the same search with the jumps read from the JumpPointTable built at level load
+//SEARCH_HPA searches the HierarchicalGraph when start and target are in different clusters, the paths arent always the shortest
+//SEARCH_BIDIRECTIONAL searches from the start and from the target at once until the two frontiers prove the best path,
+//SEARCH_BIDIRECTIONAL_PARALLEL runs the frontier from the target on a second thread
+//SEARCH_DSTAR_LITE keeps a DStarLite planner per agent that repairs its last plan a slice at a time on the calling thread
+//SEARCH_FLOW_FIELD walks down the goal distance field of the target when it has one and runs the plain search otherwise
+enum SearchMode { SEARCH_ASTAR, SEARCH_JPS, SEARCH_JPS_PLUS, SEARCH_HPA, SEARCH_BIDIRECTIONAL, SEARCH_BIDIRECTIONAL_PARALLEL, SEARCH_DSTAR_LITE, SEARCH_FLOW_FIELD, SEARCH_MODE_COUNT };
+
+inline const char* SearchModeName(SearchMode mSearchMode)
+{
+	switch (mSearchMode)
+	{
+	case SEARCH_ASTAR: return "A*";
+	case SEARCH_JPS: return "Jump Point Search";
+	case SEARCH_JPS_PLUS: return "JPS+";
+	case SEARCH_HPA: return "HPA*";
+	case SEARCH_BIDIRECTIONAL: return "Bidirectional A*";
+	case SEARCH_BIDIRECTIONAL_PARALLEL: return "Bidirectional A* on 2 threads";
+	case SEARCH_DSTAR_LITE: return "D* Lite";
+	case SEARCH_FLOW_FIELD: return "Flow field";
+	default: return "Unknown";
+	}
+}
+
+//SEARCH_RUNNING means the search ran out of its expansion budget and can be continued later
+enum SearchStatus { SEARCH_RUNNING, SEARCH_FOUND, SEARCH_FAILED };
+
+//a path asked for by one agent, iAgent is whatever id the caller tells its agents apart by
+//every agent only has one query at a time, a newer one replaces the one still being searched
+struct PathQuery
+{
+	std::uint32_t iAgent;
+	glm::ivec2 ivStartPos;
+	glm::ivec2 ivTargetPos;
+	//only for hierarchical searches, refine the path a few segments at a time while the agent walks it
+	bool bRefineLazily;
+	//only for time sliced searches, the pending searches with the highest priority share the budget of a frame first
+	int iPriority;
+};
+
+//a PathQuery together with how it should be searched, taken when the query arrives
+//so changing the search mode never affects searches that are already running
+struct PathRequest
+{
+	PathQuery query;
+	SearchMode mSearchMode;
+	std::uint32_t iRequestID;
+	//keep the visited cells for display, off in production where only the parents are needed to build the path
+	bool bVisualize;
+};
+
+//a finished search
+struct PathResult
+{
+	std::uint32_t iAgent;
+	//every request gets a new id, results of older requests for the same agent are dropped
+	std::uint32_t iRequestID;
+	//path from the target back to the start, the agent walks it from the back
+	std::vector<PathfindingNode> vecPath;
+	//hierarchical waypoints that still have to be refined into vecPath, also target first so the next one is at the back
+	std::vector<glm::ivec2> vecWaypoints;
+	//cells the search opened or closed, used to display the open and closed lists, empty when visualization is off
+	//the search space hands its buffer over instead of copying it, the buffer passed in is what it keeps for the next search
+	std::vector<std::int32_t> vecVisitedCells;
+	//cost of the whole path, 0 for lazy hierarchical paths that arent refined yet
+	float fCost;
+	//what the search did to find it, hierarchical searches only count the grid searches
+	SearchStats Stats;
+
+	PathResult(std::uint32_t iAgent = 0, std::uint32_t iRequestID = 0) : iAgent(iAgent), iRequestID(iRequestID), fCost(0.0f) {}
+
+	//empties the result but keeps what its buffers have allocated, recycled results are handed to the next searches
+	//so once the buffers have grown a search doesnt allocate anymore
+	void Clear()
+	{
+		vecPath.clear();
+		vecWaypoints.clear();
+		vecVisitedCells.clear();
+		fCost = 0.0f;
+		Stats = SearchStats();
+	}
+
+	std::size_t Capacity() const
+	{
+		return vecPath.capacity() + vecWaypoints.capacity() + vecVisitedCells.capacity();
+	}
+
+	//swaps the buffers with a recycled result
+	void SwapBuffers(PathResult& other)
+	{
+		std::swap(vecPath, other.vecPath);
+		std::swap(vecWaypoints, other.vecWaypoints);
+		std::swap(vecVisitedCells, other.vecVisitedCells);
+	}
+};
+
+//everything a search writes to, the level data itself is only read
+//the main thread and every worker thread have their own so searches can run at the same time
+struct SearchContext
+{
+	PathfindingHeap<float> OpenList;
+	//openlist of searches with integer costs, only sized for levels that use them
+	PathfindingHeap<std::int32_t> IntOpenList;
+	//openlist of levels with OPENLIST_BUCKETS, only sized for them
+	PathfindingBucketQueue BucketQueue;
+	//the G, parent and open / closed state of every cell for the current search
+	PathfindingSearchSpace SearchSpace;
+	HierarchicalGraph::Scratch HierarchyScratch;
+	std::vector<glm::ivec2> vecWaypoints, vecRefinedTiles;
+	//nodes popped off the openlist since the search began
+	std::size_t iExpansions = 0;
+	//the record of the current search, only counted with PATHFINDING_STATS
+	SearchStats Stats;
+	//bounds of HEURISTIC_LANDMARKS, null while the level has none
+	const LandmarkTable* pLandmarks = nullptr;
+	//Pathfinder::iLandmarkGeneration when the search began, the table pLandmarks points to is only the same while it is
+	std::uint32_t iLandmarkGeneration = 0;
+
+	//bidirectional searches, the frontier from the target lives in the Backward context and its cells that were
+	//opened since the threads last met are in vecOpened, the cheapest path found where the frontiers meet so far
+	//goes through iMeetingCell, -1 until they do
+	bool bParallelFrontiers = false;
+	std::vector<std::int32_t> vecOpened;
+	int iMeetingCell = -1;
+	double fMeetingCost = 0.0;
+
+	void Resize(int iCells, const SearchPolicy& policy = SearchPolicy())
+	{
+		OpenList.Resize(iCells);
+		IntOpenList.Resize(policy.IntegerCosts() ? iCells : 0);
+		BucketQueue.Resize(policy.UsesBuckets() ? iCells : 0, policy.BucketSpan());
+		SearchSpace.Resize(iCells, policy.IntegerCosts());
+		this->iCells = iCells;
+		Policy = policy;
+		if (Backward)
+			Backward->Resize(iCells, policy);
+	}
+
+	//made on the first bidirectional search, most levels never need a second search space
+	SearchContext& BackwardContext()
+	{
+		if (!Backward)
+		{
+			Backward = std::make_unique<SearchContext>();
+			Backward->Resize(iCells, Policy);
+		}
+		return *Backward;
+	}
+
+	//started on the first search with parallel frontiers
+	SearchHelperThread& HelperThread()
+	{
+		if (!Helper)
+			Helper = std::make_unique<SearchHelperThread>();
+		return *Helper;
+	}
+
+	//the openlist of that type
+	template <class OpenListType> OpenListType& OpenListOf();
+
+	std::size_t MemoryUsage() const
+	{
+		return OpenList.MemoryUsage() + IntOpenList.MemoryUsage() + BucketQueue.MemoryUsage() + SearchSpace.MemoryUsage()
+			+ (Backward ? Backward->MemoryUsage() : 0);
+	}
+
+private:
+	int iCells = 0;
+	SearchPolicy Policy;
+	std::unique_ptr<SearchContext> Backward;
+	std::unique_ptr<SearchHelperThread> Helper;
+};
+
+template <> inline PathfindingHeap<float>& SearchContext::OpenListOf<PathfindingHeap<float>>() { return OpenList; }
+template <> inline PathfindingHeap<std::int32_t>& SearchContext::OpenListOf<PathfindingHeap<std::int32_t>>() { return IntOpenList; }
+template <> inline PathfindingBucketQueue& SearchContext::OpenListOf<PathfindingBucketQueue>() { return BucketQueue; }
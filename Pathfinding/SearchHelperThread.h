@@ -0,0 +1,65 @@
+//a second thread a single search can hand half of its work to, the two frontiers of a bidirectional search
+//every SearchContext that needs one owns its own so searches on different threads never wait for each other
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class SearchHelperThread
+{
+	std::mutex mutex;
+	std::condition_variable cvWork, cvDone;
+	//a plain function and its argument, a std::function could allocate for every job
+	void (*fnJob)(void*) = nullptr;
+	void* pJob = nullptr;
+	bool bBusy = false, bStop = false;
+	//started last, once everything it waits on is constructed
+	std::thread thread;
+
+	void Work()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			cvWork.wait(lock, [this]() { return bBusy || bStop; });
+			if (bStop)
+				return;
+			lock.unlock();
+			fnJob(pJob);
+			lock.lock();
+			bBusy = false;
+			cvDone.notify_one();
+		}
+	}
+
+public:
+	SearchHelperThread() : thread(&SearchHelperThread::Work, this) {}
+
+	~SearchHelperThread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bStop = true;
+		}
+		cvWork.notify_one();
+		thread.join();
+	}
+
+	//starts fnJob(pJob) on the helper, one job at a time, Wait has to be called before the next one
+	void Run(void (*fnJob)(void*), void* pJob)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			this->fnJob = fnJob;
+			this->pJob = pJob;
+			bBusy = true;
+		}
+		cvWork.notify_one();
+	}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cvDone.wait(lock, [this]() { return !bBusy; });
+	}
+};
@@ -0,0 +1,245 @@
+//the plain grid search as a template over its policies, every combination compiles to its own loop
+//with the neighbor count, corner rule, heuristic and cost arithmetic known at compile time
+//Pathfinder picks the instantiation once per level from the SearchPolicy instead of branching per node
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <glm.hpp>
+#include "PathfindingGrid.h"
+#include "SearchContext.h"
+#include "SearchPolicy.h"
+#include "SearchStats.h"
+
+namespace SearchPolicies
+{
+	//GridDirection lists the 4 straight directions first so the connectivity is just how many of them are used
+	struct FourConnected { static constexpr int iDirections = 4; };
+	struct EightConnected { static constexpr int iDirections = 8; };
+
+	struct CornerCutting
+	{
+		static bool Allowed(const PathfindingGrid&, int, int, int, int) { return true; }
+	};
+	//a diagonal step needs both cells it passes between to be walkable
+	struct NoCornerCutting
+	{
+		static bool Allowed(const PathfindingGrid& grid, int iX, int iY, int iDX, int iDY)
+		{
+			return grid.IsWalkable(iX + iDX, iY) && grid.IsWalkable(iX, iY + iDY);
+		}
+	};
+
+	//estimates take the absolute distances on both axes, the landmarks also need the cells and are added in SearchKernel::H
+	struct Octile
+	{
+		static constexpr bool bLandmarks = false;
+		template <class Cost>
+		static typename Cost::Type Estimate(int iDX, int iDY)
+		{
+			int iMin = glm::min(iDX, iDY);
+			return Cost::Straight * static_cast<typename Cost::Type>(iDX + iDY) + (Cost::Diagonal - 2 * Cost::Straight) * static_cast<typename Cost::Type>(iMin);
+		}
+	};
+	struct Manhattan
+	{
+		static constexpr bool bLandmarks = false;
+		template <class Cost>
+		static typename Cost::Type Estimate(int iDX, int iDY)
+		{
+			return Cost::Straight * static_cast<typename Cost::Type>(iDX + iDY);
+		}
+	};
+	//scaled down to the diagonal cost so it never overestimates, the diagonal is a bit under sqrt(2) straights
+	struct Euclidean
+	{
+		static constexpr bool bLandmarks = false;
+		template <class Cost>
+		static typename Cost::Type Estimate(int iDX, int iDY)
+		{
+			float fScale = glm::min(1.0f, static_cast<float>(Cost::Diagonal) / (static_cast<float>(Cost::Straight) * 1.41421356f));
+			return static_cast<typename Cost::Type>(static_cast<float>(Cost::Straight) * fScale * std::sqrt(static_cast<float>(iDX * iDX + iDY * iDY)));
+		}
+	};
+	//dijkstra
+	struct Zero
+	{
+		static constexpr bool bLandmarks = false;
+		template <class Cost>
+		static typename Cost::Type Estimate(int, int) { return 0; }
+	};
+	//the larger of octile and the bounds of the LandmarkTable
+	struct Landmarks : Octile
+	{
+		static constexpr bool bLandmarks = true;
+	};
+}
+
+template <class Connectivity, class Corners, class Heuristic, class Cost, class OpenListType>
+struct SearchKernel
+{
+	typedef typename Cost::Type CostType;
+
+	static CostType H(const SearchContext& context, int iX, int iY, const glm::ivec2& ivTargetPos)
+	{
+		CostType Bound = Heuristic::template Estimate<Cost>(glm::abs(iX - ivTargetPos.x), glm::abs(iY - ivTargetPos.y));
+		//levels too small for any landmark have no table
+		if (Heuristic::bLandmarks && context.pLandmarks)
+			Bound = glm::max(Bound, context.pLandmarks->template Estimate<Cost>(iX, iY, ivTargetPos));
+		return Bound;
+	}
+
+	//resets the context and puts the start node on the openlist
+	static void Begin(const PathfindingGrid& grid, SearchContext& context, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos)
+	{
+		OpenListType& openList = context.template OpenListOf<OpenListType>();
+		int iStartCell = grid.Index(ivStartPos);
+		context.SearchSpace.Reset();
+		openList.Clear();
+		context.SearchSpace.Open(iStartCell, CostType(0), -1);
+		openList.Push(iStartCell, H(context, ivStartPos.x, ivStartPos.y, ivTargetPos), CostType(0));
+		SEARCH_STAT(context.Stats.iGenerated = context.Stats.iPeakOpen = context.Stats.iHeuristicCalls = 1);
+	}
+
+	//expands at most iMaxExpansions nodes, a negative count runs the search to the end
+	static SearchStatus Continue(const PathfindingGrid& grid, SearchContext& context, PathResult& result, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos, int iMaxExpansions)
+	{
+		OpenListType& openList = context.template OpenListOf<OpenListType>();
+		int iStartCell = grid.Index(ivStartPos), iTargetCell = grid.Index(ivTargetPos);
+
+		for (int iExpansions = 0; iMaxExpansions < 0 || iExpansions < iMaxExpansions; iExpansions++)
+		{
+			if (openList.Empty())
+				return SEARCH_FAILED;
+
+			int iCurrentCell = openList.Pop().iCell;
+			context.iExpansions++;
+			if (iCurrentCell == iTargetCell)
+			{
+				ConstructPath(grid, context, result, iStartCell, iTargetCell);
+				return SEARCH_FOUND;
+			}
+			Expand(grid, context, openList, iCurrentCell, [&](int iX, int iY) { return H(context, iX, iY, ivTargetPos); }, [](int) {});
+		}
+		return openList.Empty() ? SEARCH_FAILED : SEARCH_RUNNING;
+	}
+
+	//closes a node popped off the openlist and opens its neighbors, fnEstimate(iX, iY) is what F adds to G
+	//and fnOpened gets every cell whose G was set or lowered
+	template <class EstimateFunction, class OpenedFunction>
+	static void Expand(const PathfindingGrid& grid, SearchContext& context, OpenListType& openList, int iCurrentCell, EstimateFunction&& fnEstimate, OpenedFunction&& fnOpened)
+	{
+		PathfindingSearchSpace& searchSpace = context.SearchSpace;
+		std::vector<CostType>& vecG = searchSpace.template Costs<CostType>();
+		searchSpace.Close(iCurrentCell);
+		SEARCH_STAT(context.Stats.iPeakClosed++);
+
+		glm::ivec2 ivCurrentPos = grid.Position(iCurrentCell);
+		CostType G = vecG[iCurrentCell];
+		for (int iDir = 0; iDir < Connectivity::iDirections; iDir++)
+		{
+			int iDX = GridDirection::iX[iDir], iDY = GridDirection::iY[iDir];
+			int iX = ivCurrentPos.x + iDX, iY = ivCurrentPos.y + iDY;
+			if (!grid.IsWalkable(iX, iY))
+				continue;
+			bool bDiagonal = GridDirection::IsDiagonal(iDir);
+			if (bDiagonal && !Corners::Allowed(grid, ivCurrentPos.x, ivCurrentPos.y, iDX, iDY))
+				continue;
+
+			int iCell = grid.Index(iX, iY);
+			NodeState state = searchSpace.State(iCell);
+			if (state == NODE_CLOSED)
+				continue;
+			CostType nextG = G + (bDiagonal ? Cost::Diagonal : Cost::Straight);
+			if (state == NODE_NONE)
+			{
+				searchSpace.Open(iCell, nextG, iCurrentCell);
+				openList.Push(iCell, nextG + fnEstimate(iX, iY), nextG);
+				SEARCH_STAT(context.Stats.iGenerated++);
+				SEARCH_STAT(context.Stats.iHeuristicCalls++);
+				SEARCH_STAT(context.Stats.iPeakOpen = glm::max(context.Stats.iPeakOpen, openList.Size()));
+				fnOpened(iCell);
+			}
+			else if (nextG < vecG[iCell])
+			{
+				searchSpace.Open(iCell, nextG, iCurrentCell);
+				openList.DecreaseKey(iCell, nextG + fnEstimate(iX, iY), nextG);
+				SEARCH_STAT(context.Stats.iReopened++);
+				SEARCH_STAT(context.Stats.iHeuristicCalls++);
+				fnOpened(iCell);
+			}
+		}
+	}
+
+	//every step is to a neighbor so the parents are the whole path, target first
+	static void ConstructPath(const PathfindingGrid& grid, SearchContext& context, PathResult& result, int iStartCell, int iTargetCell)
+	{
+		std::vector<CostType>& vecG = context.SearchSpace.template Costs<CostType>();
+		result.fCost = Cost::ToFloat(vecG[iTargetCell]);
+		for (int iCell = iTargetCell; iCell != iStartCell; iCell = context.SearchSpace.vecParent[iCell])
+			result.vecPath.push_back(PathfindingNode(grid.Position(iCell), Cost::ToFloat(vecG[iCell])));
+
+		if (context.SearchSpace.bRecordVisited)
+			std::swap(result.vecVisitedCells, context.SearchSpace.vecVisited);
+	}
+};
+
+//the instantiation a SearchPolicy selects, of SearchKernel or another search with the same policies and entry points
+struct SearchKernelFunctions
+{
+	void (*fnBegin)(const PathfindingGrid&, SearchContext&, const glm::ivec2&, const glm::ivec2&);
+	SearchStatus (*fnContinue)(const PathfindingGrid&, SearchContext&, PathResult&, const glm::ivec2&, const glm::ivec2&, int);
+};
+
+namespace SearchKernelSelect
+{
+	template <template <class, class, class, class, class> class Kernel, class Connectivity, class Corners, class Heuristic, class Cost, class OpenListType>
+	SearchKernelFunctions Functions()
+	{
+		typedef Kernel<Connectivity, Corners, Heuristic, Cost, OpenListType> Instance;
+		return SearchKernelFunctions{ &Instance::Begin, &Instance::Continue };
+	}
+
+	//the bucket queue only for the policies it works with, the float costs never get one
+	template <template <class, class, class, class, class> class Kernel, class Connectivity, class Corners, class Heuristic, class Cost>
+	SearchKernelFunctions ByOpenList(const SearchPolicy& policy)
+	{
+		if (policy.UsesBuckets())
+			return Functions<Kernel, Connectivity, Corners, Heuristic, Cost, PathfindingBucketQueue>();
+		return Functions<Kernel, Connectivity, Corners, Heuristic, Cost, PathfindingHeap<typename Cost::Type>>();
+	}
+
+	template <template <class, class, class, class, class> class Kernel, class Connectivity, class Corners, class Heuristic>
+	SearchKernelFunctions ByCost(const SearchPolicy& policy)
+	{
+		switch (policy.mCostType)
+		{
+		case COST_INTEGER: return ByOpenList<Kernel, Connectivity, Corners, Heuristic, SearchPolicies::IntegerCost>(policy);
+		case COST_INTEGER_FINE: return ByOpenList<Kernel, Connectivity, Corners, Heuristic, SearchPolicies::FineIntegerCost>(policy);
+		default: return Functions<Kernel, Connectivity, Corners, Heuristic, SearchPolicies::FloatCost, PathfindingHeap<float>>();
+		}
+	}
+
+	template <template <class, class, class, class, class> class Kernel, class Connectivity, class Corners>
+	SearchKernelFunctions ByHeuristic(const SearchPolicy& policy)
+	{
+		switch (policy.mHeuristic)
+		{
+		case HEURISTIC_MANHATTAN: return ByCost<Kernel, Connectivity, Corners, SearchPolicies::Manhattan>(policy);
+		case HEURISTIC_EUCLIDEAN: return ByCost<Kernel, Connectivity, Corners, SearchPolicies::Euclidean>(policy);
+		case HEURISTIC_ZERO: return ByCost<Kernel, Connectivity, Corners, SearchPolicies::Zero>(policy);
+		case HEURISTIC_LANDMARKS: return ByCost<Kernel, Connectivity, Corners, SearchPolicies::Landmarks>(policy);
+		default: return ByCost<Kernel, Connectivity, Corners, SearchPolicies::Octile>(policy);
+		}
+	}
+}
+
+//4 connected grids never step diagonally so the corner rule doesnt need its own instantiations there
+template <template <class, class, class, class, class> class Kernel = SearchKernel>
+SearchKernelFunctions SelectSearchKernel(const SearchPolicy& policy)
+{
+	if (policy.mConnectivity == CONNECTIVITY_4)
+		return SearchKernelSelect::ByHeuristic<Kernel, SearchPolicies::FourConnected, SearchPolicies::CornerCutting>(policy);
+	if (policy.bCornerCutting)
+		return SearchKernelSelect::ByHeuristic<Kernel, SearchPolicies::EightConnected, SearchPolicies::CornerCutting>(policy);
+	return SearchKernelSelect::ByHeuristic<Kernel, SearchPolicies::EightConnected, SearchPolicies::NoCornerCutting>(policy);
+}
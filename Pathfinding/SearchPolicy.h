@@ -0,0 +1,91 @@
+//what a level is searched with, picked once per level with Pathfinder::SetSearchPolicy
+#pragma once
+#include <cstdint>
+
+namespace SearchPolicies
+{
+	//the same step costs the rest of the engine uses
+	struct FloatCost
+	{
+		typedef float Type;
+		static constexpr float Straight = 1.0f, Diagonal = 1.414f;
+		static float ToFloat(float fCost) { return fCost; }
+	};
+	//a straight step is iStraight units, the costs a search returns are divided back into tiles
+	template <std::int32_t iStraight, std::int32_t iDiagonal>
+	struct FixedPointCost
+	{
+		typedef std::int32_t Type;
+		static constexpr std::int32_t Straight = iStraight, Diagonal = iDiagonal;
+		static float ToFloat(std::int32_t iCost) { return static_cast<float>(iCost) / Straight; }
+	};
+	typedef FixedPointCost<10, 14> IntegerCost;
+	typedef FixedPointCost<1000, 1414> FineIntegerCost;
+}
+
+enum GridConnectivity { CONNECTIVITY_4, CONNECTIVITY_8 };
+//manhattan overestimates on 8 connected grids, the paths it finds there arent always the shortest
+//HEURISTIC_LANDMARKS is the larger of octile and the bounds of the LandmarkTable built at level load
+enum HeuristicType { HEURISTIC_OCTILE, HEURISTIC_MANHATTAN, HEURISTIC_EUCLIDEAN, HEURISTIC_ZERO, HEURISTIC_LANDMARKS };
+//fixed point costs compare exactly and dont drift, so paths of equal cost tie the same way every time
+//COST_INTEGER is 10 for a straight and 14 for a diagonal step, its diagonal is 1% under the 1.414 of COST_FLOAT
+//so its path costs are between 0.99 and 1 times the float ones
+//COST_INTEGER_FINE is 1000 and 1414, the same steps as COST_FLOAT, its costs match up to float rounding
+//G is 32 bits, with COST_INTEGER_FINE that is a path of about 1.5 million diagonal steps at most
+enum CostType { COST_FLOAT, COST_INTEGER, COST_INTEGER_FINE };
+//OPENLIST_BUCKETS is the PathfindingBucketQueue, it needs the 10/14 costs and a heuristic that is consistent on the grid
+//with 1000/1414 the cursor would walk a thousand empty buckets per tile, with anything else, and for jump point search
+//whose jumps arent single steps, the heap is used
+enum OpenListType { OPENLIST_HEAP, OPENLIST_BUCKETS };
+
+//how the grid is searched, decided per level
+//JPS, JPS+ and HPA* are built for 8 connected grids with corner cutting and the octile heuristic, any cost type
+//works for them, with the landmarks they keep to octile and only the plain search uses the landmark bounds,
+//with any other policy every search mode runs the plain search
+struct SearchPolicy
+{
+	GridConnectivity mConnectivity = CONNECTIVITY_8;
+	//diagonal steps past an obstacle on either side, MovingAI benchmarks dont allow it
+	bool bCornerCutting = true;
+	HeuristicType mHeuristic = HEURISTIC_OCTILE;
+	CostType mCostType = COST_FLOAT;
+	OpenListType mOpenList = OPENLIST_HEAP;
+
+	bool IntegerCosts() const { return mCostType != COST_FLOAT; }
+	bool SupportsPreprocessing() const
+	{
+		return mConnectivity == CONNECTIVITY_8 && bCornerCutting && (mHeuristic == HEURISTIC_OCTILE || mHeuristic == HEURISTIC_LANDMARKS);
+	}
+
+	//the heuristic never overestimates so the plain search finds the shortest paths, only manhattan on 8 connected grids does
+	bool Admissible() const
+	{
+		return !(mHeuristic == HEURISTIC_MANHATTAN && mConnectivity == CONNECTIVITY_8);
+	}
+
+	bool UsesBuckets() const
+	{
+		return mOpenList == OPENLIST_BUCKETS && mCostType == COST_INTEGER && Admissible();
+	}
+
+	//with a consistent heuristic F grows by at most a step plus what H grows by, which is at most a step again,
+	//so every F on the openlist is within twice the largest step of the one popped last, 0 without buckets
+	int BucketSpan() const
+	{
+		return UsesBuckets() ? 2 * SearchPolicies::IntegerCost::Diagonal + 1 : 0;
+	}
+};
+
+//cost of a path with that many straight and diagonal steps, added up in the cost type so it is what a search would return
+inline float PathCost(CostType mCostType, int iStraightSteps, int iDiagonalSteps)
+{
+	switch (mCostType)
+	{
+	case COST_INTEGER:
+		return SearchPolicies::IntegerCost::ToFloat(iStraightSteps * SearchPolicies::IntegerCost::Straight + iDiagonalSteps * SearchPolicies::IntegerCost::Diagonal);
+	case COST_INTEGER_FINE:
+		return SearchPolicies::FineIntegerCost::ToFloat(iStraightSteps * SearchPolicies::FineIntegerCost::Straight + iDiagonalSteps * SearchPolicies::FineIntegerCost::Diagonal);
+	default:
+		return static_cast<float>(iStraightSteps) * SearchPolicies::FloatCost::Straight + static_cast<float>(iDiagonalSteps) * SearchPolicies::FloatCost::Diagonal;
+	}
+}
@@ -0,0 +1,57 @@
+//what a single search did, to find out which queries a slow frame spent its time on
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+//the counters are compiled in unless PATHFINDING_STATS is defined to 0, without them SEARCH_STAT expands to nothing
+//and every record stays zero, the record itself is always there so the layout doesnt depend on the flag
+#ifndef PATHFINDING_STATS
+#define PATHFINDING_STATS 1
+#endif
+
+#if PATHFINDING_STATS
+#define SEARCH_STAT(statement) statement
+#else
+#define SEARCH_STAT(statement)
+#endif
+
+//allocations made on this thread, the library never counts anything into it itself
+//an executable that wants allocation counts replaces the global operator new and increments it there
+namespace PathfindingAllocations
+{
+	inline thread_local std::size_t iCount = 0;
+}
+
+struct SearchStats
+{
+	std::uint32_t iAgent = 0, iRequestID = 0;
+	//SearchMode of the request
+	int iSearchMode = 0;
+	bool bFound = false;
+	//nodes popped off the openlist, pushed onto it and pushed again with a lower G while still on it
+	std::size_t iExpansions = 0, iGenerated = 0, iReopened = 0;
+	//the most nodes the openlist held at once, the closed list only grows so its peak is its size at the end
+	std::size_t iPeakOpen = 0, iPeakClosed = 0;
+	std::size_t iHeuristicCalls = 0;
+	//heap allocations on the searching thread while it searched, 0 unless PathfindingAllocations is counted
+	std::size_t iAllocations = 0;
+	//time spent searching, over all slices for time sliced searches
+	double fMicroseconds = 0.0;
+};
+
+//adds the time and allocations of the scope it lives in to a record
+struct SearchStatsScope
+{
+	SearchStats& Stats;
+	std::chrono::steady_clock::time_point timeStart;
+	std::size_t iAllocationsStart;
+
+	SearchStatsScope(SearchStats& Stats) : Stats(Stats), timeStart(std::chrono::steady_clock::now()), iAllocationsStart(PathfindingAllocations::iCount) {}
+
+	~SearchStatsScope()
+	{
+		Stats.fMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - timeStart).count();
+		Stats.iAllocations += PathfindingAllocations::iCount - iAllocationsStart;
+	}
+};
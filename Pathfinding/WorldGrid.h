@@ -1,6 +1,6 @@
+//conversion between world positions in pixels and the tiles of the grid
 #pragma once
 #include <glm.hpp>
-#include "Components.h"
 
 namespace WorldGrid
 {
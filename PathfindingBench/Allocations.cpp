@@ -0,0 +1,39 @@
+//every allocation of the benchmark and the tests is counted so the searches can report theirs
+//kept out of Bench.cpp so the replacements arent inlined into their callers, where GCC pairs the malloc of one with the
+//operator delete of the other and warns about a mismatch
+#include <cstdlib>
+#include <new>
+#include "SearchStats.h"
+
+void* operator new(std::size_t iSize)
+{
+	PathfindingAllocations::iCount++;
+	if (void* pMemory = std::malloc(iSize ? iSize : 1))
+		return pMemory;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t iSize)
+{
+	return operator new(iSize);
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t) noexcept
+{
+	std::free(pMemory);
+}
@@ -0,0 +1,544 @@
+//search benchmark, runs MovingAI scenarios and random queries on the app levels through the Pathfinder
+//and writes what every search mode did as json so changes to the engine can be compared run against run
+//usage : PathfindingBench [-m astar|jps|jps+|hpa|bidir|bidir2|dstar|flow|all] [-n max queries] [-r random queries] [-o out.json] [-z] [-c 4|8] [-x] [-h octile|manhattan|euclidean|zero|landmarks] [-i] [-f] [-b] [-a agents] [-g goals] [-t ticks] <.scen .map .csv or random:WIDTHxHEIGHT:WALLPERCENT[:SEED]>...
+//-z fails the run if any search allocated on the heap once the warm up pass is done
+//-c -x -h -i and -f set the SearchPolicy, connectivity, no corner cutting, heuristic and 10/14 or 1000/1414 integer costs
+//-b is the bucket queue openlist, only with -i
+//with any of them JPS+ and HPA* have no preprocessing and every mode runs the plain search under that policy
+//-a moves that many agents with the cooperative planner for -t ticks, heading for -g goals, only them unless -m is given too
+//random:512x512:25 is a generated level with 25% walls, the same one on every machine, see GridMap::Generate
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "GridMap.h"
+#include "Pathfinder.h"
+
+//command line names of the search modes, in SearchMode order
+static const char* arrModeArgs[SEARCH_MODE_COUNT] = { "astar", "jps", "jps+", "hpa", "bidir", "bidir2", "dstar", "flow" };
+//in HeuristicType order
+static const char* arrHeuristicArgs[] = { "octile", "manhattan", "euclidean", "zero", "landmarks" };
+//json names of the CostType values
+static const char* arrCostArgs[] = { "float", "integer", "integer_fine" };
+
+//one query, fOptimal is the cost the scenario file gives or the cost plain A* with float costs and the octile heuristic
+//found for generated ones
+struct BenchQuery
+{
+	glm::ivec2 ivStartPos, ivTargetPos;
+	float fOptimal;
+};
+
+//everything measured for one search mode on one map
+struct BenchRun
+{
+	SearchMode mSearchMode;
+	std::size_t iSolved = 0, iFailed = 0;
+	std::size_t iExpansions = 0, iGenerated = 0, iReopened = 0, iHeuristicCalls = 0, iAllocations = 0, iPeakOpen = 0, iPeakOpenSum = 0;
+	//paths more expensive than fOptimal, and by how much at worst
+	std::size_t iSuboptimal = 0;
+	//integer costs come out a little under the float ones, the min ratio is how far
+	double fCostRatioSum = 0.0, fCostRatioMin = 1.0, fCostRatioMax = 0.0;
+	std::vector<double> vecLatencies;
+};
+
+//the agents of the cooperative planner on one map, every tick is timed and checked for agents on one cell or swapping cells
+struct CooperativeRun
+{
+	std::size_t iAgents = 0, iGoals = 0, iMemory = 0;
+	std::size_t iCollisions = 0, iArrived = 0;
+	//how much of the distance from their starts to their goals the agents walked
+	double fProgress = 0.0;
+	CooperativePlanner::Counters counters;
+	std::vector<double> vecTickLatencies;
+};
+
+struct BenchMap
+{
+	std::string strName;
+	GridMap map;
+	std::vector<BenchQuery> vecQueries;
+	double fBuildMilliseconds = 0.0;
+	std::vector<BenchRun> vecRuns;
+	CooperativeRun cooperativeRun;
+};
+
+static std::string FileName(const std::string& strPath)
+{
+	std::size_t iSlash = strPath.find_last_of("/\\");
+	return iSlash == std::string::npos ? strPath : strPath.substr(iSlash + 1);
+}
+
+static std::string Directory(const std::string& strPath)
+{
+	std::size_t iSlash = strPath.find_last_of("/\\");
+	return iSlash == std::string::npos ? std::string() : strPath.substr(0, iSlash + 1);
+}
+
+static bool EndsWith(const std::string& str, const std::string& strEnd)
+{
+	return str.size() >= strEnd.size() && str.compare(str.size() - strEnd.size(), strEnd.size(), strEnd) == 0;
+}
+
+//MovingAI scenario, "version 1" and then "bucket map width height startx starty goalx goaly optimal" per line
+//the map is looked for next to the scenario under the name it gives and then as the scenario without .scen
+static bool LoadScenario(const std::string& strPath, BenchMap& benchMap, std::size_t iMaxQueries)
+{
+	std::ifstream fileScenario(strPath);
+	if (!fileScenario.is_open())
+		return false;
+
+	std::string strLine, strMapName;
+	while (std::getline(fileScenario, strLine) && benchMap.vecQueries.size() < iMaxQueries)
+	{
+		std::stringstream ssLine(strLine);
+		int iBucket, iWidth, iHeight;
+		BenchQuery query;
+		if (!(ssLine >> iBucket >> strMapName >> iWidth >> iHeight >> query.ivStartPos.x >> query.ivStartPos.y
+			>> query.ivTargetPos.x >> query.ivTargetPos.y >> query.fOptimal))
+			continue;
+		benchMap.vecQueries.push_back(query);
+	}
+	if (benchMap.vecQueries.empty())
+		return false;
+
+	benchMap.strName = FileName(strPath);
+	if (benchMap.map.LoadMovingAI(Directory(strPath) + FileName(strMapName)))
+		return true;
+	return benchMap.map.LoadMovingAI(strPath.substr(0, strPath.size() - 5));
+}
+
+//random start and target pairs for maps without a scenario, the app levels get the spawn to the stairs first
+//their optimal cost is what plain A* finds with float costs and the octile heuristic on the same grid, so the integer
+//costs and the other heuristics are measured against it, pairs without a path are dropped
+static void GenerateQueries(BenchMap& benchMap, const SearchPolicy& policy, std::size_t iRandomQueries)
+{
+	GridMap& map = benchMap.map;
+	SearchPolicy referencePolicy = policy;
+	referencePolicy.mHeuristic = HEURISTIC_OCTILE;
+	referencePolicy.mCostType = COST_FLOAT;
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	pathfinder.SetSearchPolicy(referencePolicy);
+	map.Apply(pathfinder);
+
+	std::vector<glm::ivec2> vecWalkable;
+	for (int iY = 0; iY < map.iHeight; iY++)
+		for (int iX = 0; iX < map.iWidth; iX++)
+			if (map.IsWalkable(iX, iY))
+				vecWalkable.push_back(glm::ivec2(iX, iY));
+	if (vecWalkable.size() < 2)
+		return;
+
+	std::vector<BenchQuery> vecCandidates;
+	if (map.ivSpawnPos.x >= 0 && map.ivFinishPos.x >= 0)
+		vecCandidates.push_back(BenchQuery{ map.ivSpawnPos, map.ivFinishPos, 0.0f });
+	//fixed seed so every run measures the same queries
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<std::size_t> distCell(0, vecWalkable.size() - 1);
+	while (vecCandidates.size() < iRandomQueries)
+		vecCandidates.push_back(BenchQuery{ vecWalkable[distCell(rng)], vecWalkable[distCell(rng)], 0.0f });
+
+	PathResult result;
+	for (auto& query : vecCandidates)
+	{
+		if (!pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result))
+			continue;
+		query.fOptimal = result.fCost;
+		benchMap.vecQueries.push_back(query);
+		result.Clear();
+	}
+}
+
+static void RunQueries(BenchMap& benchMap, Pathfinder& pathfinder, BenchRun& run)
+{
+	pathfinder.SetSearchMode(run.mSearchMode);
+	PathResult result;
+	//warm up, every query runs once untimed so the search space pages are faulted in and every buffer
+	//has grown to what the longest query needs, the measured pass is the steady state
+	for (auto& query : benchMap.vecQueries)
+	{
+		pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result);
+		result.Clear();
+	}
+
+	run.vecLatencies.reserve(benchMap.vecQueries.size());
+	for (auto& query : benchMap.vecQueries)
+	{
+		auto timeStart = std::chrono::steady_clock::now();
+		bool bFound = pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result);
+		run.vecLatencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - timeStart).count());
+
+		if (!bFound)
+		{
+			run.iFailed++;
+			run.iAllocations += result.Stats.iAllocations;
+			result.Clear();
+			continue;
+		}
+		run.iSolved++;
+		const SearchStats& stats = result.Stats;
+		run.iExpansions += stats.iExpansions;
+		run.iGenerated += stats.iGenerated;
+		run.iReopened += stats.iReopened;
+		run.iHeuristicCalls += stats.iHeuristicCalls;
+		run.iAllocations += stats.iAllocations;
+		run.iPeakOpen = glm::max(run.iPeakOpen, stats.iPeakOpen);
+		run.iPeakOpenSum += stats.iPeakOpen;
+
+		//the engine uses 1.414 for diagonals and by default lets paths cut corners, so its costs can come out a little under
+		//the MovingAI ones, -x makes them comparable, only paths over the optimal cost count as suboptimal
+		double fRatio = query.fOptimal > 0.0f ? static_cast<double>(result.fCost) / query.fOptimal : 1.0;
+		run.fCostRatioSum += fRatio;
+		run.fCostRatioMin = glm::min(run.fCostRatioMin, fRatio);
+		run.fCostRatioMax = glm::max(run.fCostRatioMax, fRatio);
+		if (result.fCost > query.fOptimal * 1.0001f + 0.001f)
+			run.iSuboptimal++;
+		result.Clear();
+	}
+}
+
+//the goals and the starts are random walkable cells, every start reaches the goal of its agent and has a cell of its own
+//the goal distance fields are built before the ticks are timed, agents sharing a goal cell queue up around it so at most
+//one per goal arrives and the progress is what tells how well they moved
+static void RunCooperative(BenchMap& benchMap, Pathfinder& pathfinder, std::size_t iAgents, std::size_t iGoals, std::size_t iTicks)
+{
+	GridMap& map = benchMap.map;
+	CooperativeRun& run = benchMap.cooperativeRun;
+	std::vector<glm::ivec2> vecWalkable;
+	for (int iY = 0; iY < map.iHeight; iY++)
+		for (int iX = 0; iX < map.iWidth; iX++)
+			if (map.IsWalkable(iX, iY))
+				vecWalkable.push_back(glm::ivec2(iX, iY));
+	if (vecWalkable.size() < 2)
+		return;
+	std::mt19937 rng(1);
+	std::shuffle(vecWalkable.begin(), vecWalkable.end(), rng);
+
+	pathfinder.SetGoalFieldCapacity(iGoals);
+	std::vector<const GoalDistanceField*> vecFields;
+	std::vector<glm::ivec2> vecGoals;
+	std::size_t iNext = 0;
+	while (vecGoals.size() < iGoals && iNext < vecWalkable.size())
+	{
+		glm::ivec2 ivGoalPos = vecWalkable[iNext++];
+		vecGoals.push_back(ivGoalPos);
+		vecFields.push_back(pathfinder.GetGoalDistanceField(ivGoalPos));
+	}
+
+	CooperativePlanner& planner = pathfinder.GetCooperativePlanner();
+	std::vector<std::size_t> vecGoalOf;
+	std::vector<double> vecStartCosts;
+	while (vecGoalOf.size() < iAgents && iNext < vecWalkable.size())
+	{
+		glm::ivec2 ivGridPos = vecWalkable[iNext++];
+		std::size_t iGoal = vecGoalOf.size() % vecGoals.size();
+		if (!vecFields[iGoal]->Reaches(ivGridPos))
+			continue;
+		std::uint32_t iAgent = static_cast<std::uint32_t>(vecGoalOf.size());
+		planner.AddAgent(pathfinder.GetGrid(), iAgent, ivGridPos);
+		planner.SetGoal(iAgent, vecGoals[iGoal]);
+		vecGoalOf.push_back(iGoal);
+		vecStartCosts.push_back(vecFields[iGoal]->Cost(ivGridPos));
+	}
+	run.iAgents = vecGoalOf.size();
+	run.iGoals = vecGoals.size();
+
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	std::vector<glm::ivec2> vecPositions(run.iAgents), vecLastPositions(run.iAgents);
+	//the agent on every cell at the current tick and the one on it at the last, the stamps say which tick wrote them
+	std::vector<std::uint32_t> vecOn(grid.Width() * grid.Height()), vecWasOn(vecOn.size()), vecOnTick(vecOn.size(), 0), vecWasOnTick(vecOn.size(), 0);
+	for (std::uint32_t iAgent = 0; iAgent < run.iAgents; iAgent++)
+		vecPositions[iAgent] = planner.Position(grid, iAgent);
+	run.vecTickLatencies.reserve(iTicks);
+	planner.ResetCounters();
+	for (std::uint32_t iTick = 1; iTick <= iTicks; iTick++)
+	{
+		vecLastPositions.swap(vecPositions);
+		for (std::uint32_t iAgent = 0; iAgent < run.iAgents; iAgent++)
+		{
+			int iCell = grid.Index(vecLastPositions[iAgent]);
+			vecWasOn[iCell] = iAgent;
+			vecWasOnTick[iCell] = iTick;
+		}
+
+		auto timeStart = std::chrono::steady_clock::now();
+		pathfinder.StepCooperativeAgents();
+		run.vecTickLatencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeStart).count());
+
+		for (std::uint32_t iAgent = 0; iAgent < run.iAgents; iAgent++)
+		{
+			glm::ivec2 ivGridPos = vecPositions[iAgent] = planner.Position(grid, iAgent);
+			int iCell = grid.Index(ivGridPos);
+			if (vecOnTick[iCell] == iTick)
+				run.iCollisions++;
+			vecOn[iCell] = iAgent;
+			vecOnTick[iCell] = iTick;
+			//the agent that was on the new cell moved onto the old one
+			int iLastCell = grid.Index(vecLastPositions[iAgent]);
+			if (iCell != iLastCell && vecWasOnTick[iCell] == iTick && vecPositions[vecWasOn[iCell]] == vecLastPositions[iAgent] && vecWasOn[iCell] < iAgent)
+				run.iCollisions++;
+		}
+	}
+	run.counters = planner.GetCounters();
+	run.iMemory = planner.MemoryUsage();
+
+	double fStartCost = 0.0, fEndCost = 0.0;
+	for (std::uint32_t iAgent = 0; iAgent < run.iAgents; iAgent++)
+	{
+		const GoalDistanceField* pField = vecFields[vecGoalOf[iAgent]];
+		fStartCost += vecStartCosts[iAgent];
+		fEndCost += pField->Reaches(vecPositions[iAgent]) ? pField->Cost(vecPositions[iAgent]) : vecStartCosts[iAgent];
+		if (vecPositions[iAgent] == pField->Goal())
+			run.iArrived++;
+	}
+	run.fProgress = fStartCost > 0.0 ? 1.0 - fEndCost / fStartCost : 1.0;
+}
+
+static double Percentile(const std::vector<double>& vecSorted, double fPercentile)
+{
+	if (vecSorted.empty())
+		return 0.0;
+	std::size_t iIndex = static_cast<std::size_t>(std::ceil(fPercentile / 100.0 * vecSorted.size()));
+	return vecSorted[glm::clamp<std::size_t>(iIndex, 1, vecSorted.size()) - 1];
+}
+
+static std::string JsonString(const std::string& str)
+{
+	std::string strEscaped = "\"";
+	for (char ch : str)
+	{
+		if (ch == '"' || ch == '\\')
+			strEscaped += '\\';
+		strEscaped += ch;
+	}
+	return strEscaped + "\"";
+}
+
+static void WriteJson(std::ostream& out, const SearchPolicy& policy, std::vector<BenchMap>& vecMaps)
+{
+	out << "{\n  \"policy\": { \"connectivity\": " << (policy.mConnectivity == CONNECTIVITY_4 ? 4 : 8) << ", \"corner_cutting\": " << (policy.bCornerCutting ? "true" : "false")
+		<< ", \"heuristic\": " << JsonString(arrHeuristicArgs[policy.mHeuristic]) << ", \"costs\": " << JsonString(arrCostArgs[policy.mCostType])
+		<< ", \"openlist\": " << JsonString(policy.UsesBuckets() ? "buckets" : "heap") << " },\n";
+	out << "  \"maps\": [";
+	for (std::size_t iMap = 0; iMap < vecMaps.size(); iMap++)
+	{
+		BenchMap& benchMap = vecMaps[iMap];
+		out << (iMap ? ",\n" : "\n") << "    {\n";
+		out << "      \"name\": " << JsonString(benchMap.strName) << ",\n";
+		out << "      \"width\": " << benchMap.map.iWidth << ",\n";
+		out << "      \"height\": " << benchMap.map.iHeight << ",\n";
+		out << "      \"queries\": " << benchMap.vecQueries.size() << ",\n";
+		out << "      \"build_ms\": " << benchMap.fBuildMilliseconds << ",\n";
+		out << "      \"runs\": [";
+		for (std::size_t iRun = 0; iRun < benchMap.vecRuns.size(); iRun++)
+		{
+			BenchRun& run = benchMap.vecRuns[iRun];
+			std::sort(run.vecLatencies.begin(), run.vecLatencies.end());
+			double fTotal = 0.0;
+			for (double fLatency : run.vecLatencies)
+				fTotal += fLatency;
+			double fSolved = static_cast<double>(glm::max<std::size_t>(run.iSolved, 1));
+
+			out << (iRun ? ",\n" : "\n") << "        {\n";
+			out << "          \"mode\": " << JsonString(arrModeArgs[run.mSearchMode]) << ",\n";
+			out << "          \"solved\": " << run.iSolved << ",\n";
+			out << "          \"failed\": " << run.iFailed << ",\n";
+			out << "          \"expansions\": " << run.iExpansions << ",\n";
+			out << "          \"expansions_mean\": " << run.iExpansions / fSolved << ",\n";
+			out << "          \"generated\": " << run.iGenerated << ",\n";
+			out << "          \"generated_mean\": " << run.iGenerated / fSolved << ",\n";
+			out << "          \"reopened\": " << run.iReopened << ",\n";
+			out << "          \"heuristic_calls\": " << run.iHeuristicCalls << ",\n";
+			out << "          \"allocations\": " << run.iAllocations << ",\n";
+			out << "          \"allocations_mean\": " << run.iAllocations / fSolved << ",\n";
+			out << "          \"peak_open_max\": " << run.iPeakOpen << ",\n";
+			out << "          \"peak_open_mean\": " << run.iPeakOpenSum / fSolved << ",\n";
+			out << "          \"suboptimal\": " << run.iSuboptimal << ",\n";
+			out << "          \"cost_ratio_mean\": " << run.fCostRatioSum / fSolved << ",\n";
+			out << "          \"cost_ratio_min\": " << run.fCostRatioMin << ",\n";
+			out << "          \"cost_ratio_max\": " << run.fCostRatioMax << ",\n";
+			out << "          \"latency_us\": { \"p50\": " << Percentile(run.vecLatencies, 50.0) << ", \"p99\": " << Percentile(run.vecLatencies, 99.0)
+				<< ", \"max\": " << (run.vecLatencies.empty() ? 0.0 : run.vecLatencies.back()) << ", \"total\": " << fTotal << " }\n";
+			out << "        }";
+		}
+		out << "\n      ]";
+
+		CooperativeRun& cooperativeRun = benchMap.cooperativeRun;
+		if (cooperativeRun.iAgents)
+		{
+			const CooperativePlanner::Counters& counters = cooperativeRun.counters;
+			std::sort(cooperativeRun.vecTickLatencies.begin(), cooperativeRun.vecTickLatencies.end());
+			double fTicks = static_cast<double>(glm::max<std::size_t>(counters.iTicks, 1));
+			double fPlans = static_cast<double>(glm::max<std::size_t>(counters.iPlans, 1));
+			out << ",\n      \"cooperative\": {\n";
+			out << "        \"agents\": " << cooperativeRun.iAgents << ",\n";
+			out << "        \"goals\": " << cooperativeRun.iGoals << ",\n";
+			out << "        \"ticks\": " << counters.iTicks << ",\n";
+			out << "        \"plans\": " << counters.iPlans << ",\n";
+			out << "        \"plans_per_tick\": " << counters.iPlans / fTicks << ",\n";
+			out << "        \"plans_per_second\": " << (counters.fMicroseconds > 0.0 ? counters.iPlans / counters.fMicroseconds * 1e6 : 0.0) << ",\n";
+			out << "        \"deferred\": " << counters.iDeferred << ",\n";
+			out << "        \"expansions_mean\": " << counters.iExpansions / fPlans << ",\n";
+			out << "        \"collisions\": " << cooperativeRun.iCollisions << ",\n";
+			out << "        \"arrived\": " << cooperativeRun.iArrived << ",\n";
+			out << "        \"progress\": " << cooperativeRun.fProgress << ",\n";
+			out << "        \"memory_bytes\": " << cooperativeRun.iMemory << ",\n";
+			out << "        \"tick_ms\": { \"p50\": " << Percentile(cooperativeRun.vecTickLatencies, 50.0) << ", \"p99\": " << Percentile(cooperativeRun.vecTickLatencies, 99.0)
+				<< ", \"max\": " << (cooperativeRun.vecTickLatencies.empty() ? 0.0 : cooperativeRun.vecTickLatencies.back()) << " }\n";
+			out << "      }";
+		}
+		out << "\n    }";
+	}
+	out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<SearchMode> vecModes;
+	std::size_t iMaxQueries = static_cast<std::size_t>(-1), iRandomQueries = 1000;
+	std::size_t iAgents = 0, iGoals = 16, iTicks = 200;
+	std::string strOutput;
+	bool bZeroAllocations = false;
+	SearchPolicy policy;
+	std::vector<std::string> vecPaths;
+	for (int iArg = 1; iArg < argc; iArg++)
+	{
+		std::string strArg = argv[iArg];
+		if ((strArg == "-m" || strArg == "-n" || strArg == "-r" || strArg == "-o" || strArg == "-c" || strArg == "-h"
+			|| strArg == "-a" || strArg == "-g" || strArg == "-t") && iArg + 1 < argc)
+		{
+			std::string strValue = argv[++iArg];
+			if (strArg == "-c")
+				policy.mConnectivity = strValue == "4" ? CONNECTIVITY_4 : CONNECTIVITY_8;
+			else if (strArg == "-h")
+			{
+				auto it = std::find(std::begin(arrHeuristicArgs), std::end(arrHeuristicArgs), strValue);
+				if (it == std::end(arrHeuristicArgs))
+				{
+					spdlog::error("Unknown heuristic {}", strValue);
+					return 1;
+				}
+				policy.mHeuristic = static_cast<HeuristicType>(it - std::begin(arrHeuristicArgs));
+			}
+			else if (strArg == "-n")
+				iMaxQueries = std::strtoul(strValue.c_str(), nullptr, 10);
+			else if (strArg == "-r")
+				iRandomQueries = std::strtoul(strValue.c_str(), nullptr, 10);
+			else if (strArg == "-o")
+				strOutput = strValue;
+			else if (strArg == "-a")
+				iAgents = std::strtoul(strValue.c_str(), nullptr, 10);
+			else if (strArg == "-g")
+				iGoals = glm::max<std::size_t>(std::strtoul(strValue.c_str(), nullptr, 10), 1);
+			else if (strArg == "-t")
+				iTicks = std::strtoul(strValue.c_str(), nullptr, 10);
+			else
+			{
+				for (int iMode = 0; iMode < SEARCH_MODE_COUNT; iMode++)
+					if (strValue == "all" || strValue == arrModeArgs[iMode])
+						vecModes.push_back(static_cast<SearchMode>(iMode));
+				if (vecModes.empty())
+				{
+					spdlog::error("Unknown search mode {}", strValue);
+					return 1;
+				}
+			}
+		}
+		else if (strArg == "-z")
+			bZeroAllocations = true;
+		else if (strArg == "-x")
+			policy.bCornerCutting = false;
+		else if (strArg == "-i")
+			policy.mCostType = COST_INTEGER;
+		else if (strArg == "-f")
+			policy.mCostType = COST_INTEGER_FINE;
+		else if (strArg == "-b")
+			policy.mOpenList = OPENLIST_BUCKETS;
+		else
+			vecPaths.push_back(strArg);
+	}
+	if (vecPaths.empty())
+	{
+		std::cerr << "usage : " << argv[0] << " [-m astar|jps|jps+|hpa|bidir|bidir2|dstar|flow|all] [-n max queries] [-r random queries] [-o out.json] [-z] [-c 4|8] [-x] [-h octile|manhattan|euclidean|zero|landmarks] [-i] [-f] [-b] [-a agents] [-g goals] [-t ticks] <.scen .map .csv or random:WIDTHxHEIGHT:WALLPERCENT[:SEED]>...\n";
+		return 1;
+	}
+	if (vecModes.empty() && iAgents == 0)
+		vecModes = { SEARCH_ASTAR, SEARCH_JPS, SEARCH_JPS_PLUS, SEARCH_HPA };
+	//the json goes to stdout unless -o is given, so the level loading logs are kept out of the way
+	spdlog::set_level(spdlog::level::warn);
+
+	std::vector<BenchMap> vecMaps;
+	for (auto& strPath : vecPaths)
+	{
+		BenchMap benchMap;
+		bool bScenario = EndsWith(strPath, ".scen");
+		if (bScenario ? !LoadScenario(strPath, benchMap, iMaxQueries) : !benchMap.map.Load(strPath))
+		{
+			spdlog::error("Cant load {}", strPath);
+			return 1;
+		}
+		if (!bScenario)
+			benchMap.strName = FileName(strPath);
+
+		Pathfinder pathfinder;
+		pathfinder.SetVisualization(false);
+		pathfinder.SetSearchPolicy(policy);
+		pathfinder.SetJumpPointPreprocessing(std::find(vecModes.begin(), vecModes.end(), SEARCH_JPS_PLUS) != vecModes.end());
+		pathfinder.SetHierarchicalClusterSize(std::find(vecModes.begin(), vecModes.end(), SEARCH_HPA) != vecModes.end() ? 16 : 0);
+		auto timeStart = std::chrono::steady_clock::now();
+		benchMap.map.Apply(pathfinder);
+		benchMap.fBuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+
+		if (!bScenario && !vecModes.empty())
+			GenerateQueries(benchMap, policy, glm::min(iRandomQueries, iMaxQueries));
+		for (SearchMode mSearchMode : vecModes)
+		{
+			BenchRun run;
+			run.mSearchMode = mSearchMode;
+			RunQueries(benchMap, pathfinder, run);
+			benchMap.vecRuns.push_back(std::move(run));
+		}
+		if (iAgents)
+			RunCooperative(benchMap, pathfinder, iAgents, iGoals, iTicks);
+		vecMaps.push_back(std::move(benchMap));
+	}
+
+	if (strOutput.empty())
+		WriteJson(std::cout, policy, vecMaps);
+	else
+	{
+		std::ofstream fileOutput(strOutput);
+		if (!fileOutput.is_open())
+		{
+			spdlog::error("Cant write {}", strOutput);
+			return 1;
+		}
+		WriteJson(fileOutput, policy, vecMaps);
+	}
+
+	if (bZeroAllocations)
+	{
+		bool bAllocated = false;
+		for (auto& benchMap : vecMaps)
+		{
+			for (auto& run : benchMap.vecRuns)
+			{
+				if (run.iAllocations == 0)
+					continue;
+				spdlog::error("{} with {} : {} heap allocations after the warm up", benchMap.strName, arrModeArgs[run.mSearchMode], run.iAllocations);
+				bAllocated = true;
+			}
+		}
+		if (bAllocated)
+			return 2;
+	}
+	return 0;
+}
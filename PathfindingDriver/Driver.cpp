@@ -0,0 +1,107 @@
+//headless query driver, loads a level and answers path queries read from stdin without any window
+//usage : PathfindingDriver <tilemap.csv, MovingAI .map or random:WIDTHxHEIGHT:WALLPERCENT[:SEED]> [astar|jps|jps+|hpa|bidir|bidir2|dstar|flow] [threads]
+//every line of input is a query "startx starty targetx targety", an empty input asks for spawn to stairs
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "GridMap.h"
+#include "Pathfinder.h"
+
+//command line names of the search modes, in SearchMode order
+static const char* arrModeArgs[SEARCH_MODE_COUNT] = { "astar", "jps", "jps+", "hpa", "bidir", "bidir2", "dstar", "flow" };
+
+static bool ParseSearchMode(const std::string& strMode, SearchMode& mSearchMode)
+{
+	for (int iMode = 0; iMode < SEARCH_MODE_COUNT; iMode++)
+	{
+		if (strMode == arrModeArgs[iMode])
+		{
+			mSearchMode = static_cast<SearchMode>(iMode);
+			return true;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage : " << argv[0] << " <tilemap.csv or .map> [astar|jps|jps+|hpa|bidir|bidir2|dstar|flow] [threads]\n";
+		return 1;
+	}
+
+	GridMap map;
+	if (!map.Load(argv[1]))
+	{
+		spdlog::error("Cant open map {}", argv[1]);
+		return 1;
+	}
+
+	SearchMode mSearchMode = SEARCH_ASTAR;
+	if (argc > 2 && !ParseSearchMode(argv[2], mSearchMode))
+	{
+		spdlog::error("Unknown search mode {}", argv[2]);
+		return 1;
+	}
+	int iThreads = argc > 3 ? std::atoi(argv[3]) : 0;
+
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	pathfinder.SetSearchMode(mSearchMode);
+	if (mSearchMode == SEARCH_JPS_PLUS)
+		pathfinder.SetJumpPointPreprocessing(true);
+	else if (mSearchMode == SEARCH_HPA)
+		pathfinder.SetHierarchicalClusterSize(16);
+	map.Apply(pathfinder);
+	if (iThreads > 0)
+		pathfinder.StartWorkers(iThreads);
+
+	std::vector<PathQuery> vecQueries;
+	std::string strLine;
+	while (std::getline(std::cin, strLine))
+	{
+		std::stringstream ssLine(strLine);
+		PathQuery query{};
+		if (ssLine >> query.ivStartPos.x >> query.ivStartPos.y >> query.ivTargetPos.x >> query.ivTargetPos.y)
+		{
+			//every query is its own agent so a later one doesnt replace it
+			query.iAgent = static_cast<std::uint32_t>(vecQueries.size());
+			vecQueries.push_back(query);
+		}
+	}
+	if (vecQueries.empty() && map.ivSpawnPos.x >= 0 && map.ivFinishPos.x >= 0)
+		vecQueries.push_back(PathQuery{ 0, map.ivSpawnPos, map.ivFinishPos, false, 0 });
+
+	auto timeStart = std::chrono::steady_clock::now();
+	for (auto& query : vecQueries)
+		pathfinder.Submit(query);
+	pathfinder.Wait();
+	std::vector<PathResult> vecResults;
+	pathfinder.Update(vecResults);
+	float fMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+
+	//results only come back for queries that found a path, and not in submission order when threaded
+	std::vector<const PathResult*> vecByQuery(vecQueries.size(), nullptr);
+	for (auto& result : vecResults)
+		vecByQuery[result.iAgent] = &result;
+	for (std::size_t iQuery = 0; iQuery < vecQueries.size(); iQuery++)
+	{
+		const PathQuery& query = vecQueries[iQuery];
+		std::cout << query.ivStartPos.x << " " << query.ivStartPos.y << " " << query.ivTargetPos.x << " " << query.ivTargetPos.y;
+		const PathResult* result = vecByQuery[iQuery];
+		if (!result)
+		{
+			std::cout << " nopath\n";
+			continue;
+		}
+		//hierarchical paths come back as waypoints between the entrances, the tiles of the first leg are refined already
+		std::cout << " tiles " << result->vecPath.size() << " waypoints " << result->vecWaypoints.size() << "\n";
+	}
+	spdlog::info("{} queries with {} in {:.3f} ms", vecQueries.size(), SearchModeName(mSearchMode), fMilliseconds);
+	return 0;
+}
@@ -0,0 +1,863 @@
+//headless checks of the engine on generated levels, every test logs what went wrong and returns false
+//usage : PathfindingTests [test]..., no test runs all of them, ctest runs every one of them on its own
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "GridMap.h"
+#include "PathCache.h"
+#include "Pathfinder.h"
+
+struct TestQuery
+{
+	glm::ivec2 ivStartPos, ivTargetPos;
+};
+
+static GridMap RandomMap(int iWidth, int iHeight, int iWallPercent, std::uint32_t iSeed)
+{
+	GridMap map;
+	map.Generate(iWidth, iHeight, iWallPercent, iSeed);
+	return map;
+}
+
+static std::vector<glm::ivec2> WalkableCells(const PathfindingGrid& grid)
+{
+	std::vector<glm::ivec2> vecWalkable;
+	for (int iCell = 0; iCell < grid.Size(); iCell++)
+		if (grid.IsWalkable(grid.Position(iCell)))
+			vecWalkable.push_back(grid.Position(iCell));
+	return vecWalkable;
+}
+
+static std::vector<TestQuery> RandomQueries(const PathfindingGrid& grid, std::size_t iQueries, std::uint32_t iSeed)
+{
+	std::vector<glm::ivec2> vecWalkable = WalkableCells(grid);
+	std::vector<TestQuery> vecQueries;
+	std::mt19937 rng(iSeed);
+	for (std::size_t iQuery = 0; iQuery < iQueries && !vecWalkable.empty(); iQuery++)
+		vecQueries.push_back(TestQuery{ vecWalkable[rng() % vecWalkable.size()], vecWalkable[rng() % vecWalkable.size()] });
+	return vecQueries;
+}
+
+static PathfindingGrid ToGrid(const GridMap& map)
+{
+	PathfindingGrid grid;
+	grid.Resize(map.iWidth, map.iHeight);
+	for (int iY = 0; iY < map.iHeight; iY++)
+		for (int iX = 0; iX < map.iWidth; iX++)
+			grid.SetWalkable(glm::ivec2(iX, iY), map.IsWalkable(iX, iY));
+	return grid;
+}
+
+//dijkstra from the target over the 8 neighbours with corner cutting and the float step costs, the default policy
+//written out on its own so the engine is checked against something that shares no code with it
+//the cost from every cell to the target, -1 where it cant be reached
+static std::vector<double> ReferenceCosts(const PathfindingGrid& grid, const glm::ivec2& ivTargetPos)
+{
+	typedef std::pair<double, int> QueueEntry;
+	std::vector<double> vecCosts(grid.Size(), -1.0);
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+	vecCosts[grid.Index(ivTargetPos)] = 0.0;
+	queue.push(QueueEntry(0.0, grid.Index(ivTargetPos)));
+	while (!queue.empty())
+	{
+		QueueEntry entry = queue.top();
+		queue.pop();
+		if (entry.first > vecCosts[entry.second])
+			continue;
+		glm::ivec2 ivPos = grid.Position(entry.second);
+		for (int iDY = -1; iDY <= 1; iDY++)
+		{
+			for (int iDX = -1; iDX <= 1; iDX++)
+			{
+				if ((iDX == 0 && iDY == 0) || !grid.IsWalkable(ivPos.x + iDX, ivPos.y + iDY))
+					continue;
+				int iNextCell = grid.Index(ivPos.x + iDX, ivPos.y + iDY);
+				double fCost = entry.first + (iDX != 0 && iDY != 0 ? 1.414 : 1.0);
+				if (vecCosts[iNextCell] < 0.0 || fCost < vecCosts[iNextCell])
+				{
+					vecCosts[iNextCell] = fCost;
+					queue.push(QueueEntry(fCost, iNextCell));
+				}
+			}
+		}
+	}
+	return vecCosts;
+}
+
+static bool SameCost(double fCost, double fReference)
+{
+	return std::abs(fCost - fReference) <= 1e-4 * fReference + 1e-3;
+}
+
+//the path runs from the target back to the start, every step goes to a walkable neighbour and the steps add up to fCost
+static bool ValidPath(const PathfindingGrid& grid, const glm::ivec2& ivStartPos, const glm::ivec2& ivTargetPos, const PathResult& result)
+{
+	if (ivStartPos == ivTargetPos)
+		return result.vecPath.empty() || (result.vecPath.size() == 1 && result.vecPath[0].ivGridPos == ivTargetPos);
+	if (result.vecPath.empty() || result.vecPath.front().ivGridPos != ivTargetPos)
+		return false;
+	glm::ivec2 ivPos = ivStartPos;
+	double fCost = 0.0;
+	for (auto it = result.vecPath.rbegin(); it != result.vecPath.rend(); ++it)
+	{
+		glm::ivec2 ivStep = it->ivGridPos - ivPos;
+		if (!grid.IsWalkable(it->ivGridPos) || ivStep == glm::ivec2(0) || glm::abs(ivStep.x) > 1 || glm::abs(ivStep.y) > 1)
+			return false;
+		fCost += ivStep.x != 0 && ivStep.y != 0 ? 1.414 : 1.0;
+		ivPos = it->ivGridPos;
+	}
+	return SameCost(result.fCost, fCost);
+}
+
+//any tile, the edits toggle it between wall and floor
+static glm::ivec2 RandomTile(const PathfindingGrid& grid, std::mt19937& rng)
+{
+	return glm::ivec2(rng() % grid.Width(), rng() % grid.Height());
+}
+
+static const SearchMode arrAllModes[] = { SEARCH_ASTAR, SEARCH_JPS, SEARCH_JPS_PLUS, SEARCH_HPA, SEARCH_BIDIRECTIONAL,
+	SEARCH_BIDIRECTIONAL_PARALLEL, SEARCH_DSTAR_LITE, SEARCH_FLOW_FIELD };
+
+//every mode answers the same queries twice, the first pass grows the buffers and the second must not allocate at all
+static bool TestAllocations()
+{
+	GridMap map = RandomMap(128, 128, 20, 1);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	pathfinder.SetJumpPointPreprocessing(true);
+	pathfinder.SetHierarchicalClusterSize(16);
+	map.Apply(pathfinder);
+	std::vector<TestQuery> vecQueries = RandomQueries(pathfinder.GetGrid(), 100, 2);
+	//the flow field mode only walks a field for the goal it was built for, half the queries head there
+	pathfinder.GetGoalDistanceField(vecQueries[0].ivTargetPos, true);
+	for (std::size_t iQuery = 0; iQuery < vecQueries.size(); iQuery += 2)
+		vecQueries[iQuery].ivTargetPos = vecQueries[0].ivTargetPos;
+
+	bool bPassed = true;
+	PathResult result;
+	for (SearchMode mSearchMode : arrAllModes)
+	{
+		pathfinder.SetSearchMode(mSearchMode);
+		for (int iPass = 0; iPass < 2; iPass++)
+		{
+			std::size_t iAllocations = 0;
+			for (auto& query : vecQueries)
+			{
+				pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result);
+				iAllocations += result.Stats.iAllocations;
+				result.Clear();
+			}
+			if (iPass == 1 && iAllocations != 0)
+			{
+				spdlog::error("{} : {} heap allocations after the warm up", SearchModeName(mSearchMode), iAllocations);
+				bPassed = false;
+			}
+		}
+	}
+	return bPassed;
+}
+
+//the jump distances patched after every edit are the ones a fresh Build gives
+static bool TestIncrementalJumpPoints()
+{
+	std::mt19937 rng(3);
+	int iMismatches = 0;
+	for (int iMap = 0; iMap < 8; iMap++)
+	{
+		PathfindingGrid grid = ToGrid(RandomMap(40 + rng() % 120, 40 + rng() % 120, rng() % 45, rng()));
+		JumpPointTable table, fresh;
+		table.Build(grid);
+		for (int iEdit = 0; iEdit < 150; iEdit++)
+		{
+			glm::ivec2 ivGridPos = RandomTile(grid, rng);
+			grid.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+			table.TileChanged(grid, ivGridPos);
+			fresh.Build(grid);
+			for (int iCell = 0; iCell < grid.Size(); iCell++)
+				for (int iDir = 0; iDir < GridDirection::iCount; iDir++)
+					iMismatches += table.Distance(iCell, iDir) != fresh.Distance(iCell, iDir);
+		}
+	}
+	if (iMismatches)
+		spdlog::error("{} jump distances differ from a fresh build", iMismatches);
+	return iMismatches == 0;
+}
+
+//the labels patched by AddCell and RemoveCell split the cells into the same regions as a fresh Build, whatever the
+//labels themselves are, so every label has to map to exactly one label of the fresh regions
+static bool TestIncrementalRegions()
+{
+	std::mt19937 rng(3);
+	int iMismatches = 0;
+	for (int iMap = 0; iMap < 8; iMap++)
+	{
+		PathfindingGrid grid = ToGrid(RandomMap(40 + rng() % 60, 30 + rng() % 60, 30 + rng() % 25, rng()));
+		ConnectedRegions regions, fresh;
+		regions.Build(grid);
+		for (int iEdit = 0; iEdit < 400; iEdit++)
+		{
+			glm::ivec2 ivGridPos = RandomTile(grid, rng);
+			bool bWalkable = !grid.IsWalkable(ivGridPos);
+			grid.SetWalkable(ivGridPos, bWalkable);
+			if (bWalkable)
+				regions.AddCell(grid, ivGridPos);
+			else
+				regions.RemoveCell(grid, ivGridPos);
+			fresh.Build(grid);
+
+			std::unordered_map<std::uint32_t, std::uint32_t> mapToFresh, mapFromFresh;
+			bool bSame = regions.Count() == fresh.Count();
+			for (int iCell = 0; iCell < grid.Size() && bSame; iCell++)
+			{
+				std::uint32_t iLabel = regions.Label(iCell), iFreshLabel = fresh.Label(iCell);
+				if (!grid.IsWalkable(grid.Position(iCell)))
+				{
+					bSame = iLabel == 0;
+					continue;
+				}
+				auto itTo = mapToFresh.emplace(iLabel, iFreshLabel).first;
+				auto itFrom = mapFromFresh.emplace(iFreshLabel, iLabel).first;
+				bSame = itTo->second == iFreshLabel && itFrom->second == iLabel;
+			}
+			iMismatches += !bSame;
+		}
+	}
+	if (iMismatches)
+		spdlog::error("{} edits left regions that differ from a fresh build", iMismatches);
+	return iMismatches == 0;
+}
+
+//entrances by cell and their edges as (cell, cost in thousandths), sorted, so two graphs compare whatever their node ids
+static std::vector<std::pair<int, int>> NodeEdges(const HierarchicalGraph& graph, int iNode)
+{
+	std::vector<std::pair<int, int>> vecEdges;
+	for (auto& edge : graph.GetNode(iNode).vecEdges)
+		vecEdges.push_back(std::make_pair(graph.GetNode(edge.iNode).iCell, static_cast<int>(std::lround(edge.fCost * 1000.0f))));
+	std::sort(vecEdges.begin(), vecEdges.end());
+	return vecEdges;
+}
+
+//the entrances and the paths between them patched by TileChanged are the ones a fresh Build gives, half the edits are
+//on cluster borders where the entrances themselves change
+static bool TestIncrementalHierarchy()
+{
+	std::mt19937 rng(3);
+	int iMismatches = 0;
+	for (int iMap = 0; iMap < 5; iMap++)
+	{
+		int iClusterSize = 8 + rng() % 12;
+		PathfindingGrid grid = ToGrid(RandomMap(30 + rng() % 80, 30 + rng() % 80, rng() % 40, rng()));
+		HierarchicalGraph graph, fresh;
+		graph.Build(grid, iClusterSize);
+		for (int iEdit = 0; iEdit < 120; iEdit++)
+		{
+			glm::ivec2 ivGridPos = RandomTile(grid, rng);
+			if (iEdit % 2)
+				ivGridPos.x = glm::min(ivGridPos.x / iClusterSize * iClusterSize + (rng() % 2 ? iClusterSize - 1 : 0), grid.Width() - 1);
+			grid.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+			graph.TileChanged(grid, ivGridPos);
+			fresh.Build(grid, iClusterSize);
+
+			bool bSame = graph.NodeCount() == fresh.NodeCount();
+			for (int iCell = 0; iCell < grid.Size() && bSame; iCell++)
+			{
+				int iNode = graph.NodeAt(iCell), iFreshNode = fresh.NodeAt(iCell);
+				if (iNode < 0 || iFreshNode < 0)
+					bSame = iNode == iFreshNode;
+				else
+					bSame = NodeEdges(graph, iNode) == NodeEdges(fresh, iFreshNode);
+			}
+			iMismatches += !bSame;
+		}
+	}
+	if (iMismatches)
+		spdlog::error("{} edits left a cluster graph that differs from a fresh build", iMismatches);
+	return iMismatches == 0;
+}
+
+//the query in every mode against the reference dijkstra, HPA* only has to find a valid path at least as long as the
+//shortest one, every other mode the shortest, returns how many modes got it wrong
+static int WrongPaths(Pathfinder& pathfinder, const TestQuery& query, const std::vector<SearchMode>& vecModes, PathResult& result)
+{
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	double fOptimal = ReferenceCosts(grid, query.ivTargetPos)[grid.Index(query.ivStartPos)];
+	int iWrong = (fOptimal >= 0.0) != pathfinder.Connected(query.ivStartPos, query.ivTargetPos);
+	for (SearchMode mSearchMode : vecModes)
+	{
+		pathfinder.SetSearchMode(mSearchMode);
+		bool bFound = pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result);
+		bool bCost = mSearchMode == SEARCH_HPA ? result.fCost >= fOptimal - 1e-3 : SameCost(result.fCost, fOptimal);
+		bool bValid = !bFound || ValidPath(grid, query.ivStartPos, query.ivTargetPos, result);
+		if (bFound != (fOptimal >= 0.0) || (bFound && (!bCost || !bValid)))
+		{
+			spdlog::error("{} from ({}, {}) to ({}, {}) : found {} valid {} cost {}, the reference costs {}", SearchModeName(mSearchMode),
+				query.ivStartPos.x, query.ivStartPos.y, query.ivTargetPos.x, query.ivTargetPos.y, bFound, bValid, result.fCost, fOptimal);
+			iWrong++;
+		}
+		result.Clear();
+	}
+	return iWrong;
+}
+
+//walls toggled through SetWalkable and the searches after every edit against the reference dijkstra
+static bool TestEditedPaths()
+{
+	GridMap map = RandomMap(96, 96, 25, 4);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	pathfinder.SetJumpPointPreprocessing(true);
+	pathfinder.SetHierarchicalClusterSize(16);
+	map.Apply(pathfinder);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+
+	std::mt19937 rng(5);
+	int iWrong = 0;
+	PathResult result;
+	for (int iEdit = 0; iEdit < 100; iEdit++)
+	{
+		glm::ivec2 ivGridPos = RandomTile(grid, rng);
+		pathfinder.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+		for (auto& query : RandomQueries(grid, 4, rng()))
+			iWrong += WrongPaths(pathfinder, query, { SEARCH_ASTAR, SEARCH_JPS, SEARCH_JPS_PLUS, SEARCH_HPA, SEARCH_BIDIRECTIONAL }, result);
+	}
+	return iWrong == 0;
+}
+
+//the grid searches on levels from open to cluttered, jump point search and both bidirectional searches have to find
+//paths of the same cost as the plain search, unreachable targets included
+static bool TestSearchModes()
+{
+	int iWrong = 0;
+	PathResult result;
+	for (int iWallPercent : { 5, 20, 35, 45 })
+	{
+		GridMap map = RandomMap(128, 96, iWallPercent, iWallPercent);
+		Pathfinder pathfinder;
+		pathfinder.SetVisualization(false);
+		pathfinder.SetHierarchicalClusterSize(16);
+		map.Apply(pathfinder);
+		for (auto& query : RandomQueries(pathfinder.GetGrid(), 100, 6))
+			iWrong += WrongPaths(pathfinder, query, { SEARCH_ASTAR, SEARCH_JPS, SEARCH_HPA, SEARCH_BIDIRECTIONAL, SEARCH_BIDIRECTIONAL_PARALLEL }, result);
+	}
+	return iWrong == 0;
+}
+
+//JPS+ reads its jumps from the table built at load, with every cost type it has to find paths as short as the plain
+//search does, 10/14 costs are a little under the float ones so there it is checked against the plain search alone
+static bool TestJumpPointTable()
+{
+	int iWrong = 0;
+	PathResult result, plainResult;
+	for (CostType mCostType : { COST_FLOAT, COST_INTEGER_FINE, COST_INTEGER })
+	{
+		for (int iWallPercent : { 10, 35 })
+		{
+			GridMap map = RandomMap(160, 80, iWallPercent, iWallPercent);
+			SearchPolicy policy;
+			policy.mCostType = mCostType;
+			Pathfinder pathfinder;
+			pathfinder.SetVisualization(false);
+			pathfinder.SetSearchPolicy(policy);
+			pathfinder.SetJumpPointPreprocessing(true);
+			map.Apply(pathfinder);
+			for (auto& query : RandomQueries(pathfinder.GetGrid(), 100, 7))
+			{
+				if (mCostType != COST_INTEGER)
+				{
+					iWrong += WrongPaths(pathfinder, query, { SEARCH_JPS_PLUS }, result);
+					continue;
+				}
+				PathQuery pathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 };
+				pathfinder.SetSearchMode(SEARCH_ASTAR);
+				bool bPlainFound = pathfinder.FindPath(pathQuery, plainResult);
+				pathfinder.SetSearchMode(SEARCH_JPS_PLUS);
+				bool bFound = pathfinder.FindPath(pathQuery, result);
+				if (bFound != bPlainFound || result.fCost != plainResult.fCost)
+				{
+					spdlog::error("JPS+ with 10/14 costs from ({}, {}) to ({}, {}) costs {}, the plain search {}",
+						query.ivStartPos.x, query.ivStartPos.y, query.ivTargetPos.x, query.ivTargetPos.y, result.fCost, plainResult.fCost);
+					iWrong++;
+				}
+				result.Clear();
+				plainResult.Clear();
+			}
+		}
+	}
+	return iWrong == 0;
+}
+
+//every cell of the field against the reference dijkstra out of its goal, and every step downhill has to come out at
+//the cost of the cell it leaves less the cost of the step, returns how many cells are wrong
+static int WrongFieldCells(const PathfindingGrid& grid, const GoalDistanceField& field)
+{
+	std::vector<double> vecCosts = ReferenceCosts(grid, field.Goal());
+	int iWrong = 0;
+	for (int iCell = 0; iCell < grid.Size(); iCell++)
+	{
+		glm::ivec2 ivGridPos = grid.Position(iCell), ivNextPos;
+		if (field.Reaches(ivGridPos) != (vecCosts[iCell] >= 0.0) || (vecCosts[iCell] >= 0.0 && !SameCost(field.Cost(iCell), vecCosts[iCell])))
+		{
+			iWrong++;
+			continue;
+		}
+		if (ivGridPos == field.Goal() || !field.Next(ivGridPos, ivNextPos))
+			continue;
+		glm::ivec2 ivStep = glm::abs(ivNextPos - ivGridPos);
+		double fStep = ivStep.x + ivStep.y == 2 ? 1.414 : 1.0;
+		iWrong += !grid.IsWalkable(ivNextPos) || !SameCost(field.Cost(ivNextPos) + fStep, field.Cost(ivGridPos));
+	}
+	return iWrong;
+}
+
+//goal distance fields against the reference dijkstra, when they are built, after walls toggled around them made them
+//stale and they were built again off the frame, and when their goal is walled
+static bool TestGoalFields()
+{
+	GridMap map = RandomMap(96, 80, 25, 8);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	map.Apply(pathfinder);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	std::vector<TestQuery> vecGoals = RandomQueries(grid, 4, 9);
+	pathfinder.GetGoalDistanceField(vecGoals[0].ivTargetPos, true);
+	for (std::size_t iGoal = 1; iGoal < vecGoals.size(); iGoal++)
+		pathfinder.GetGoalDistanceField(vecGoals[iGoal].ivTargetPos);
+
+	std::mt19937 rng(10);
+	int iWrong = 0;
+	std::vector<PathResult> vecResults;
+	PathResult result;
+	for (int iRound = 0; iRound < 12; iRound++)
+	{
+		for (auto& goal : vecGoals)
+		{
+			const GoalDistanceField* pField = pathfinder.FindGoalDistanceField(goal.ivTargetPos);
+			if (!pField || pField->Stale())
+			{
+				spdlog::error("the field of ({}, {}) is missing or stale in round {}", goal.ivTargetPos.x, goal.ivTargetPos.y, iRound);
+				iWrong++;
+				continue;
+			}
+			int iWrongCells = WrongFieldCells(grid, *pField);
+			if (iWrongCells)
+				spdlog::error("{} cells of the field of ({}, {}) are wrong in round {}", iWrongCells, goal.ivTargetPos.x, goal.ivTargetPos.y, iRound);
+			iWrong += iWrongCells;
+			//the flow field mode walks down the field, that path has to be the shortest one as well
+			iWrong += WrongPaths(pathfinder, TestQuery{ goal.ivStartPos, goal.ivTargetPos }, { SEARCH_FLOW_FIELD }, result);
+		}
+		for (int iEdit = 0; iEdit < 5; iEdit++)
+		{
+			glm::ivec2 ivGridPos = RandomTile(grid, rng);
+			if (std::none_of(vecGoals.begin(), vecGoals.end(), [&](const TestQuery& goal) { return goal.ivTargetPos == ivGridPos; }))
+				pathfinder.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+		}
+		pathfinder.Wait();
+		pathfinder.Update(vecResults);
+	}
+
+	//a walled goal takes its field with it, pinned or not
+	for (auto& goal : vecGoals)
+		pathfinder.SetWalkable(goal.ivTargetPos, false);
+	pathfinder.Wait();
+	pathfinder.Update(vecResults);
+	for (auto& goal : vecGoals)
+	{
+		if (pathfinder.FindGoalDistanceField(goal.ivTargetPos))
+		{
+			spdlog::error("the field of the walled goal ({}, {}) is still there", goal.ivTargetPos.x, goal.ivTargetPos.y);
+			iWrong++;
+		}
+	}
+	return iWrong == 0;
+}
+
+//the cache the way the app uses it, every miss is searched and kept, half the queries run between two cells of a path
+//found earlier so they can be sliced out of it, and every 50 queries a wall goes on a cached path
+//whatever the cache hands out has to be a valid shortest path on the level as it is now
+static bool TestPathCache()
+{
+	GridMap map = RandomMap(96, 96, 20, 12);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	map.Apply(pathfinder);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	std::vector<glm::ivec2> vecWalkable = WalkableCells(grid);
+	PathCache cache;
+	cache.SetCapacity(16);
+
+	std::mt19937 rng(13);
+	int iWrong = 0;
+	std::vector<std::vector<glm::ivec2>> vecFoundPaths;
+	PathResult result, cachedResult;
+	for (int iQuery = 0; iQuery < 1500; iQuery++)
+	{
+		TestQuery query{ vecWalkable[rng() % vecWalkable.size()], vecWalkable[rng() % vecWalkable.size()] };
+		if (!vecFoundPaths.empty() && rng() % 2)
+		{
+			const std::vector<glm::ivec2>& vecCells = vecFoundPaths[rng() % vecFoundPaths.size()];
+			query = TestQuery{ vecCells[rng() % vecCells.size()], vecCells[rng() % vecCells.size()] };
+		}
+		//the wall goes on the newest path, which is still cached, and the query asks for that path again
+		if (iQuery % 50 == 49 && !vecFoundPaths.empty() && vecFoundPaths.back().size() > 2)
+		{
+			const std::vector<glm::ivec2>& vecCells = vecFoundPaths.back();
+			query = TestQuery{ vecCells.front(), vecCells.back() };
+			pathfinder.SetWalkable(vecCells[1 + rng() % (vecCells.size() - 2)], false);
+		}
+		if (!grid.IsWalkable(query.ivStartPos) || !grid.IsWalkable(query.ivTargetPos))
+			continue;
+
+		if (cache.Find(grid, pathfinder.GetLevelGeneration(), query.ivStartPos, query.ivTargetPos, cachedResult.vecPath, cachedResult.fCost))
+		{
+			double fOptimal = ReferenceCosts(grid, query.ivTargetPos)[grid.Index(query.ivStartPos)];
+			if (!SameCost(cachedResult.fCost, fOptimal) || !ValidPath(grid, query.ivStartPos, query.ivTargetPos, cachedResult))
+			{
+				spdlog::error("the cached path from ({}, {}) to ({}, {}) costs {}, the reference {}", query.ivStartPos.x, query.ivStartPos.y,
+					query.ivTargetPos.x, query.ivTargetPos.y, cachedResult.fCost, fOptimal);
+				iWrong++;
+			}
+			cachedResult.Clear();
+			continue;
+		}
+		if (pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result))
+		{
+			cache.Insert(grid, pathfinder.GetLevelGeneration(), query.ivStartPos, query.ivTargetPos, result.vecPath, true);
+			std::vector<glm::ivec2> vecCells(1, query.ivStartPos);
+			for (auto it = result.vecPath.rbegin(); it != result.vecPath.rend(); ++it)
+				vecCells.push_back(it->ivGridPos);
+			vecFoundPaths.push_back(vecCells);
+		}
+		result.Clear();
+	}
+	const PathCache::Counters& counters = cache.GetCounters();
+	if (counters.iHits == 0 || counters.iSubPathHits == 0)
+	{
+		spdlog::error("the cache had {} hits and {} sub path hits, the test didnt reach it", counters.iHits, counters.iSubPathHits);
+		iWrong++;
+	}
+
+	//a path that isnt the shortest is only handed out for its own query
+	cache.Clear();
+	pathfinder.SetSearchMode(SEARCH_HPA);
+	std::vector<glm::ivec2> vecCells;
+	TestQuery query = RandomQueries(grid, 1, 14)[0];
+	if (pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result) && result.vecPath.size() > 2)
+	{
+		cache.Insert(grid, pathfinder.GetLevelGeneration(), query.ivStartPos, query.ivTargetPos, result.vecPath, false);
+		glm::ivec2 ivMiddlePos = result.vecPath[result.vecPath.size() / 2].ivGridPos;
+		iWrong += !cache.Find(grid, pathfinder.GetLevelGeneration(), query.ivStartPos, query.ivTargetPos, cachedResult.vecPath, cachedResult.fCost);
+		iWrong += cache.Find(grid, pathfinder.GetLevelGeneration(), query.ivStartPos, ivMiddlePos, cachedResult.vecPath, cachedResult.fCost);
+	}
+	return iWrong == 0;
+}
+
+//an agent walking its D* Lite plan while its target drifts and walls go up around it and on its path, every repaired
+//plan has to be as short as a fresh search, once blocking and once time sliced for several agents through Update
+static bool TestDStarLite()
+{
+	GridMap map = RandomMap(96, 96, 20, 15);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	map.Apply(pathfinder);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	std::vector<glm::ivec2> vecWalkable = WalkableCells(grid);
+
+	std::mt19937 rng(16);
+	int iWrong = 0;
+	PathResult result;
+	for (int iTrial = 0; iTrial < 10; iTrial++)
+	{
+		TestQuery query{ vecWalkable[rng() % vecWalkable.size()], vecWalkable[rng() % vecWalkable.size()] };
+		for (int iStep = 0; iStep < 25 && grid.IsWalkable(query.ivStartPos) && grid.IsWalkable(query.ivTargetPos); iStep++)
+		{
+			iWrong += WrongPaths(pathfinder, query, { SEARCH_DSTAR_LITE }, result);
+			pathfinder.SetSearchMode(SEARCH_DSTAR_LITE);
+			if (!pathfinder.FindPath(PathQuery{ 0, query.ivStartPos, query.ivTargetPos, false, 0 }, result))
+				break;
+			std::size_t iAdvance = glm::min<std::size_t>(rng() % 6, result.vecPath.size());
+			if (iAdvance)
+				query.ivStartPos = result.vecPath[result.vecPath.size() - iAdvance].ivGridPos;
+			switch (rng() % 3)
+			{
+			case 0:
+			{
+				glm::ivec2 ivTargetPos = query.ivTargetPos + glm::ivec2(static_cast<int>(rng() % 5) - 2, static_cast<int>(rng() % 5) - 2);
+				if (grid.IsWalkable(ivTargetPos))
+					query.ivTargetPos = ivTargetPos;
+				break;
+			}
+			case 1:
+			{
+				for (int iEdit = 0; iEdit < 3; iEdit++)
+				{
+					glm::ivec2 ivGridPos = RandomTile(grid, rng);
+					if (ivGridPos != query.ivStartPos && ivGridPos != query.ivTargetPos)
+						pathfinder.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+				}
+				glm::ivec2 ivWallPos = result.vecPath.empty() ? query.ivStartPos : result.vecPath[result.vecPath.size() / 2].ivGridPos;
+				if (ivWallPos != query.ivStartPos && ivWallPos != query.ivTargetPos)
+					pathfinder.SetWalkable(ivWallPos, false);
+				break;
+			}
+			}
+			result.Clear();
+		}
+		result.Clear();
+	}
+
+	pathfinder.SetSearchMode(SEARCH_DSTAR_LITE);
+	pathfinder.SetSearchBudget(300, 0);
+	std::vector<PathResult> vecResults;
+	for (int iRound = 0; iRound < 10; iRound++)
+	{
+		std::vector<TestQuery> vecQueries = RandomQueries(grid, 3, rng());
+		for (std::uint32_t iAgent = 0; iAgent < vecQueries.size(); iAgent++)
+			pathfinder.Submit(PathQuery{ iAgent + 1, vecQueries[iAgent].ivStartPos, vecQueries[iAgent].ivTargetPos, false, 0 });
+		std::vector<bool> vecDone(vecQueries.size(), false);
+		for (int iFrame = 0; iFrame < 1000 && std::find(vecDone.begin(), vecDone.end(), false) != vecDone.end(); iFrame++)
+		{
+			pathfinder.Update(vecResults);
+			for (auto& sliceResult : vecResults)
+			{
+				const TestQuery& query = vecQueries[sliceResult.iAgent - 1];
+				double fOptimal = ReferenceCosts(grid, query.ivTargetPos)[grid.Index(query.ivStartPos)];
+				if (!SameCost(sliceResult.fCost, fOptimal) || !ValidPath(grid, query.ivStartPos, query.ivTargetPos, sliceResult))
+				{
+					spdlog::error("the sliced D* Lite plan of agent {} costs {}, the reference {}", sliceResult.iAgent, sliceResult.fCost, fOptimal);
+					iWrong++;
+				}
+				vecDone[sliceResult.iAgent - 1] = true;
+			}
+			vecResults.clear();
+			//the unreachable targets never get a result
+			for (std::size_t iQuery = 0; iQuery < vecQueries.size(); iQuery++)
+				if (!pathfinder.Connected(vecQueries[iQuery].ivStartPos, vecQueries[iQuery].ivTargetPos))
+					vecDone[iQuery] = true;
+		}
+		if (std::find(vecDone.begin(), vecDone.end(), false) != vecDone.end())
+		{
+			spdlog::error("a sliced D* Lite plan didnt finish in round {}", iRound);
+			iWrong++;
+		}
+		//a tile toggled between the rounds, the planners of the agents are repaired for it
+		glm::ivec2 ivWallPos = RandomTile(grid, rng);
+		if (ivWallPos != vecQueries[0].ivStartPos && ivWallPos != vecQueries[0].ivTargetPos)
+			pathfinder.SetWalkable(ivWallPos, !grid.IsWalkable(ivWallPos));
+	}
+	return iWrong == 0;
+}
+
+//agents planned with WHCA* toward a few shared goals, with goals changing and tiles toggling under them, and one goal
+//walled in partway so the agents heading there have to give up on it
+//no two agents may stand on a cell at the same tick or swap cells, and every tick is a single step onto a walkable cell
+static bool TestCooperative()
+{
+	GridMap map = RandomMap(64, 64, 10, 17);
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	map.Apply(pathfinder);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+	CooperativePlanner& planner = pathfinder.GetCooperativePlanner();
+	std::vector<glm::ivec2> vecWalkable = WalkableCells(grid);
+	std::mt19937 rng(18);
+	std::shuffle(vecWalkable.begin(), vecWalkable.end(), rng);
+
+	const std::uint32_t iAgents = 150;
+	glm::ivec2 ivWalledGoalPos = vecWalkable.back();
+	std::vector<glm::ivec2> vecGoals = { vecWalkable[vecWalkable.size() - 2], vecWalkable[vecWalkable.size() - 3], ivWalledGoalPos };
+	for (std::uint32_t iAgent = 0; iAgent < iAgents; iAgent++)
+	{
+		planner.AddAgent(grid, iAgent, vecWalkable[iAgent]);
+		planner.SetGoal(iAgent, vecGoals[rng() % vecGoals.size()]);
+	}
+
+	std::vector<glm::ivec2> vecPositions(iAgents), vecLastPositions(iAgents);
+	for (std::uint32_t iAgent = 0; iAgent < iAgents; iAgent++)
+		vecPositions[iAgent] = planner.Position(grid, iAgent);
+	int iCollisions = 0, iSwaps = 0, iJumps = 0, iOnWalls = 0, iMoves = 0;
+	std::unordered_map<int, std::uint32_t> mapOccupied;
+	for (int iTick = 0; iTick < 200; iTick++)
+	{
+		mapOccupied.clear();
+		for (std::uint32_t iAgent = 0; iAgent < iAgents; iAgent++)
+			mapOccupied[grid.Index(vecPositions[iAgent])] = iAgent;
+		if (iTick == 20)
+		{
+			for (int iDY = -2; iDY <= 2; iDY++)
+				for (int iDX = -2; iDX <= 2; iDX++)
+				{
+					glm::ivec2 ivGridPos = ivWalledGoalPos + glm::ivec2(iDX, iDY);
+					if (glm::max(glm::abs(iDX), glm::abs(iDY)) == 2 && grid.InBounds(ivGridPos.x, ivGridPos.y) && !mapOccupied.count(grid.Index(ivGridPos)))
+						pathfinder.SetWalkable(ivGridPos, false);
+				}
+		}
+		if (iTick % 10 == 5)
+		{
+			for (int iEdit = 0; iEdit < 4; iEdit++)
+			{
+				glm::ivec2 ivGridPos = RandomTile(grid, rng);
+				if (!mapOccupied.count(grid.Index(ivGridPos)) && std::find(vecGoals.begin(), vecGoals.end(), ivGridPos) == vecGoals.end())
+					pathfinder.SetWalkable(ivGridPos, !grid.IsWalkable(ivGridPos));
+			}
+		}
+		if (iTick % 30 == 10)
+			for (int iChange = 0; iChange < 15; iChange++)
+				planner.SetGoal(rng() % iAgents, vecGoals[rng() % vecGoals.size()]);
+
+		pathfinder.StepCooperativeAgents();
+		pathfinder.Wait();
+		vecLastPositions.swap(vecPositions);
+		mapOccupied.clear();
+		for (std::uint32_t iAgent = 0; iAgent < iAgents; iAgent++)
+		{
+			glm::ivec2 ivGridPos = vecPositions[iAgent] = planner.Position(grid, iAgent);
+			glm::ivec2 ivStep = glm::abs(ivGridPos - vecLastPositions[iAgent]);
+			iCollisions += !mapOccupied.emplace(grid.Index(ivGridPos), iAgent).second;
+			iJumps += ivStep.x > 1 || ivStep.y > 1;
+			iOnWalls += !grid.IsWalkable(ivGridPos);
+			iMoves += ivGridPos != vecLastPositions[iAgent];
+		}
+		for (std::uint32_t iAgent = 0; iAgent < iAgents; iAgent++)
+		{
+			auto it = mapOccupied.find(grid.Index(vecLastPositions[iAgent]));
+			if (vecPositions[iAgent] != vecLastPositions[iAgent] && it != mapOccupied.end() && it->second != iAgent &&
+				vecLastPositions[it->second] == vecPositions[iAgent])
+				iSwaps++;
+		}
+	}
+	if (iCollisions || iSwaps || iJumps || iOnWalls || iMoves == 0)
+	{
+		spdlog::error("{} agents sharing a cell, {} swaps, {} jumps, {} on walls and {} moves", iCollisions, iSwaps, iJumps, iOnWalls, iMoves);
+		return false;
+	}
+	return true;
+}
+
+//time sliced searches with the landmark heuristic while the landmarks are cleared and rebuilt under them, the tile
+//that opens is walled in on every side so no path changes and every result has to be the shortest one
+static bool TestSlicedLandmarks()
+{
+	GridMap map = RandomMap(160, 160, 30, 19);
+	glm::ivec2 ivSealedPos(5, 5);
+	for (int iY = ivSealedPos.y - 2; iY <= ivSealedPos.y + 2; iY++)
+		for (int iX = ivSealedPos.x - 2; iX <= ivSealedPos.x + 2; iX++)
+			map.vecWalkable[iY * map.iWidth + iX] = 0;
+	SearchPolicy policy;
+	policy.mHeuristic = HEURISTIC_LANDMARKS;
+	Pathfinder pathfinder;
+	pathfinder.SetVisualization(false);
+	pathfinder.SetSearchPolicy(policy);
+	map.Apply(pathfinder);
+	pathfinder.SetSearchBudget(48, 0);
+	const PathfindingGrid& grid = pathfinder.GetGrid();
+
+	std::mt19937 rng(20);
+	int iWrong = 0, iResults = 0;
+	std::vector<TestQuery> vecQueries;
+	std::vector<double> vecOptimal;
+	std::vector<PathResult> vecResults;
+	auto CheckResults = [&]()
+	{
+		for (auto& result : vecResults)
+		{
+			const TestQuery& query = vecQueries[result.iAgent];
+			if (!SameCost(result.fCost, vecOptimal[result.iAgent]) || !ValidPath(grid, query.ivStartPos, query.ivTargetPos, result))
+			{
+				spdlog::error("the sliced search from ({}, {}) to ({}, {}) costs {}, the reference {}", query.ivStartPos.x, query.ivStartPos.y,
+					query.ivTargetPos.x, query.ivTargetPos.y, result.fCost, vecOptimal[result.iAgent]);
+				iWrong++;
+			}
+			iResults++;
+		}
+		vecResults.clear();
+	};
+	for (int iRound = 0; iRound < 20; iRound++)
+	{
+		vecQueries = RandomQueries(grid, 4, rng());
+		vecOptimal.clear();
+		for (std::uint32_t iAgent = 0; iAgent < vecQueries.size(); iAgent++)
+		{
+			const TestQuery& query = vecQueries[iAgent];
+			vecOptimal.push_back(ReferenceCosts(grid, query.ivTargetPos)[grid.Index(query.ivStartPos)]);
+			pathfinder.Submit(PathQuery{ iAgent, query.ivStartPos, query.ivTargetPos, false, 0 });
+		}
+		for (int iFrame = 0; iFrame < 400; iFrame++)
+		{
+			//cleared a few frames in, and rebuilt off the frame while the searches go on
+			if (iFrame == 3)
+				pathfinder.SetWalkable(ivSealedPos, true);
+			else if (iFrame == 4)
+				pathfinder.SetWalkable(ivSealedPos, false);
+			pathfinder.Update(vecResults);
+			CheckResults();
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+		pathfinder.Wait();
+		pathfinder.Update(vecResults);
+		CheckResults();
+	}
+	if (iResults == 0)
+		spdlog::error("no sliced search finished");
+	return iWrong == 0 && iResults > 0;
+}
+
+struct Test
+{
+	const char* szName;
+	bool (*Run)();
+};
+
+static const Test arrTests[] = {
+	{ "allocations", TestAllocations },
+	{ "incremental_jump_points", TestIncrementalJumpPoints },
+	{ "incremental_regions", TestIncrementalRegions },
+	{ "incremental_hierarchy", TestIncrementalHierarchy },
+	{ "edited_paths", TestEditedPaths },
+	{ "search_modes", TestSearchModes },
+	{ "jump_point_table", TestJumpPointTable },
+	{ "goal_fields", TestGoalFields },
+	{ "path_cache", TestPathCache },
+	{ "dstar_lite", TestDStarLite },
+	{ "cooperative", TestCooperative },
+	{ "sliced_landmarks", TestSlicedLandmarks },
+};
+
+int main(int argc, char* argv[])
+{
+	spdlog::set_level(spdlog::level::warn);
+	std::vector<std::string> vecNames(argv + 1, argv + argc);
+	int iFailed = 0;
+	for (auto& strName : vecNames)
+	{
+		bool bKnown = false;
+		for (auto& test : arrTests)
+			bKnown |= strName == test.szName;
+		if (!bKnown)
+		{
+			spdlog::error("Unknown test {}", strName);
+			return 1;
+		}
+	}
+	for (auto& test : arrTests)
+	{
+		bool bSelected = vecNames.empty();
+		for (auto& strName : vecNames)
+			bSelected |= strName == test.szName;
+		if (!bSelected)
+			continue;
+		bool bPassed = test.Run();
+		std::cout << (bPassed ? "passed " : "FAILED ") << test.szName << "\n";
+		iFailed += !bPassed;
+	}
+	return iFailed ? 1 : 0;
+}
@@ -1,5 +1,5 @@
 #pragma once
-#include <deque>
+#include <vector>
 #include <glm.hpp>
 #include <SDL.h>
 #include "PathfindingNode.h"
@@ -9,7 +9,10 @@ struct PathfindingComponent
 {
 	//the actual path with the nodes is stored here after the a* is applied by the PathFindingSystem
 	//move the entity along this path then using MovementSystem
-	std::deque<PathfindingNode> deqPath;
+	std::vector<PathfindingNode> vecPath;
+	//waypoints of a lazily refined hierarchical path, target first like vecPath so the back is where vecPath currently ends
+	//AStarPathfindingSystem keeps refining the next segment onto the front of vecPath as the entity walks
+	std::vector<glm::ivec2> vecWaypoints;
 
 	//the node on the back of the queue is targeted by entity and the cycle repeats until all the entities are popped
 	//distance is calculated from the entity to this node and that distance is used to check if the entity has reached the path node 
@@ -19,10 +22,15 @@ struct PathfindingComponent
 	bool bSetTargetNode;
 	//check if the target has to move along the path or if it has reached its target
 	bool bFollowPath;
+	//flow field mode, every next node is read off the goal distance field of ivFlowGoal and vecPath stays empty
+	glm::ivec2 ivFlowGoal;
+	bool bFollowFlowField;
 
 	PathfindingComponent()
 	{
 		vTargetNodePosition = glm::ivec2(0);
+		ivFlowGoal = glm::ivec2(0);
+		bFollowFlowField = false;
 		bFollowPath = false;
 		bSetTargetNode = false;
 		fTargetNodeDistance = 0.0f;
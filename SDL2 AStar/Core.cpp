@@ -1,9 +1,12 @@
 #include "Core.h"
 #include <SDL_image.h>
 #include <string>
+#include <thread>
 #include <fstream>
 #include <spdlog/spdlog.h>
 
+//pixels per second the player walks
+static constexpr float fPlayerVelocity = 200.0f;
 
 Core::Core()
 {
@@ -17,6 +20,19 @@ Core::Core()
 	mDispatcher = std::make_unique<entt::dispatcher>();
 	mAssetStore = std::make_unique<AssetStore>();
 	mAStarSystem = std::make_unique<AStarPathfindingSystem>();
+	Pathfinder& pathfinder = mAStarSystem->GetPathfinder();
+	//the levels are small, the JPS+ table costs next to nothing to build
+	pathfinder.SetJumpPointPreprocessing(true);
+	pathfinder.SetHierarchicalClusterSize(16);
+	//leave the other half of the cores to the main thread and the driver, on a single core the searches are
+	//time sliced instead so a long search cant stall a frame
+	int iCores = static_cast<int>(std::thread::hardware_concurrency());
+	if (iCores > 1)
+		pathfinder.StartWorkers(iCores / 2);
+	else
+		pathfinder.SetSearchBudget(2000, 2000);
+	//the last searches as text, dumped when a frame spends too long on pathfinding
+	pathfinder.EnableStatsLog(32);
 	mPathfollowingSystem = std::make_unique<PathFollowingSystem>();
 	mRenderingSystem = std::make_unique<RenderingSystem>();
 	mMouseInputSystem = std::make_unique<MouseInputSystem>();
@@ -47,6 +63,8 @@ void Core::Init()
 
 	//systems subscribing to events 
 	mDispatcher->sink<TargetPositionEvent>().connect<&AStarPathfindingSystem::ProcessPathNodes>(mAStarSystem);
+	mDispatcher->sink<PathResultEvent>().connect<&AStarPathfindingSystem::ReceivePathResult>(mAStarSystem);
+	mDispatcher->sink<TileEditEvent>().connect<&AStarPathfindingSystem::ProcessTileEdit>(mAStarSystem);
 
 	LoadAssets();
 }
@@ -76,7 +94,7 @@ void Core::LoadLevel()
 	auto& transformPlayer = mRegistry->emplace<TransformComponent>(entityPlayer, glm::vec2(0.0f));
 	mRegistry->emplace<PathfindingComponent>(entityPlayer);
 	mRegistry->emplace<CameraFollowComponent>(entityPlayer);
-	mRegistry->emplace<RigidBodyComponent>(entityPlayer, 200.0f);
+	mRegistry->emplace<RigidBodyComponent>(entityPlayer, fPlayerVelocity);
 	mRegistry->emplace<SpriteComponent>(entityPlayer, mAssetStore->GetTexture("sprite-player"), glm::ivec2(32));
 
 	//Load the tilemap
@@ -87,6 +105,10 @@ void Core::LoadLevel()
 	{
 		char ch;
 		int iRow = 0, iColumn = 0;
+		//dimensions of the map in tiles, the last line ends with a newline so iRow and iColumn alone arent enough
+		int iMapWidth = 0, iMapHeight = 0;
+		//the stairs, every path the player takes there is read off their goal distance field
+		glm::ivec2 ivFinishPos(-1);
 		while ((ch = fileTilemap.get()) != EOF)
 		{
 			//check what to do with newline or end of file
@@ -102,6 +124,8 @@ void Core::LoadLevel()
 			else
 			{
 				int8_t index = atoi(&ch);
+				iMapWidth = glm::max(iMapWidth, iColumn + 1);
+				iMapHeight = glm::max(iMapHeight, iRow + 1);
 				//0 in the map is just empty space ignore it
 				if (index >= 0)
 				{
@@ -122,22 +146,30 @@ void Core::LoadLevel()
 						mRegistry->emplace<SpriteComponent>(entity, mAssetStore->GetTexture("sprite-tile"), glm::ivec2(32));
 						mRegistry->emplace<TileComponent>(entity, PATH, ivGridPos);
 						//only insert valid path nodes to the system
-						mAStarSystem->InsertNode(ivGridPos);
+						mAStarSystem->GetPathfinder().InsertNode(ivGridPos);
 						break;
 					case FINISH:
 						mPathfollowingSystem->SetNodeNextLevel(ivGridPos);
+						ivFinishPos = ivGridPos;
 						mRegistry->emplace<SpriteComponent>(entity, mAssetStore->GetTexture("sprite-stairs"), glm::ivec2(32));
 						mRegistry->emplace<TileComponent>(entity, FINISH, ivGridPos);
-						mAStarSystem->InsertNode(ivGridPos);
+						mAStarSystem->GetPathfinder().InsertNode(ivGridPos);
 						break;
 					}
 				}
 			}
 		}
 
+		//all path nodes are inserted, now the pathfinding grid can be sized
+		mAStarSystem->GetPathfinder().BuildGrid(iMapWidth, iMapHeight);
+		//pinned so no other field pushes it out, a level without stairs has none
+		mAStarSystem->GetPathfinder().GetGoalDistanceField(ivFinishPos, true);
+		//and the tiles the search results are painted on can be indexed
+		mAStarSystem->BuildTileIndex(mRegistry);
+
 		//init camera 
 		rectCamera = { 0,0, mWidth, mHeight };
-		mCameraFollowingSystem->SetMapDimensions(iColumn * (WorldGrid::fTileSize), iRow * static_cast<int>(WorldGrid::fTileSize));
+		mCameraFollowingSystem->SetMapDimensions(iMapWidth * static_cast<int>(WorldGrid::fTileSize), iMapHeight * static_cast<int>(WorldGrid::fTileSize));
 	}
 	else
 		spdlog::error("Tilemap file not found : " + strFilename);
@@ -169,6 +201,49 @@ void Core::ProcessInput()
 			case SDLK_ESCAPE:
 				bRunning = false;
 				break;
+			case SDLK_TAB:
+			{
+				//cycle through the pathfinding search modes
+				SearchMode mSearchMode = static_cast<SearchMode>((mAStarSystem->GetPathfinder().GetSearchMode() + 1) % SEARCH_MODE_COUNT);
+				mAStarSystem->GetPathfinder().SetSearchMode(mSearchMode);
+				spdlog::info("Search mode : " + std::string(SearchModeName(mSearchMode)));
+				break;
+			}
+			case SDLK_b:
+			{
+				//bucket queue or heap as the openlist, the buckets need integer costs, both from the next level on
+				SearchPolicy policy = mAStarSystem->GetPathfinder().GetSearchPolicy();
+				policy.mOpenList = policy.mOpenList == OPENLIST_BUCKETS ? OPENLIST_HEAP : OPENLIST_BUCKETS;
+				policy.mCostType = policy.mOpenList == OPENLIST_BUCKETS ? COST_INTEGER : COST_FLOAT;
+				mAStarSystem->GetPathfinder().SetSearchPolicy(policy);
+				spdlog::info("Openlist from the next level : " + std::string(policy.mOpenList == OPENLIST_BUCKETS ? "buckets" : "heap"));
+				break;
+			}
+			case SDLK_l:
+			{
+				//landmark bounds or plain octile as the heuristic, the landmarks are built with the next level
+				SearchPolicy policy = mAStarSystem->GetPathfinder().GetSearchPolicy();
+				policy.mHeuristic = policy.mHeuristic == HEURISTIC_LANDMARKS ? HEURISTIC_OCTILE : HEURISTIC_LANDMARKS;
+				mAStarSystem->GetPathfinder().SetSearchPolicy(policy);
+				spdlog::info("Heuristic from the next level : " + std::string(policy.mHeuristic == HEURISTIC_LANDMARKS ? "landmarks" : "octile"));
+				break;
+			}
+			case SDLK_f:
+				//flow fields, every entity clicked to the same tile follows the one field of that tile instead of searching
+				mAStarSystem->SetFlowFields(!mAStarSystem->GetFlowFields());
+				spdlog::info("Flow fields : " + std::string(mAStarSystem->GetFlowFields() ? "on" : "off"));
+				break;
+			case SDLK_c:
+				//cooperative planning, entities plan around each other a tick at a time, a tick is as long as the player
+				//takes for the diagonal of a tile and a little more
+				mAStarSystem->SetCooperative(!mAStarSystem->GetCooperative(), 1.5f * WorldGrid::fTileSize / fPlayerVelocity);
+				spdlog::info("Cooperative planning : " + std::string(mAStarSystem->GetCooperative() ? "on" : "off"));
+				break;
+			case SDLK_v:
+				//production mode, the searches stop keeping what they visited and the tiles are left alone
+				mAStarSystem->GetPathfinder().SetVisualization(!mAStarSystem->GetPathfinder().GetVisualization());
+				spdlog::info("Search visualization : " + std::string(mAStarSystem->GetPathfinder().GetVisualization() ? "on" : "off"));
+				break;
 			}
 
 			break;
@@ -197,8 +272,17 @@ void Core::Update()
 	float fDeltaTime = static_cast<float>(SDL_GetTicks() - iTicksLastFrame) / 1000.0f;
 	iTicksLastFrame = SDL_GetTicks();
 
-	mAStarSystem->Update(mRegistry, mAssetStore);
-	if (mPathfollowingSystem->Update(mRegistry, fDeltaTime))
+	Uint64 iCounterStart = SDL_GetPerformanceCounter();
+	mAStarSystem->Update(mRegistry, mDispatcher, mAssetStore, fDeltaTime);
+	float fPathfindingMilliseconds = static_cast<float>(SDL_GetPerformanceCounter() - iCounterStart) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+	//a quarter of the frame went into pathfinding, the last searches tell which queries it was
+	if (fPathfindingMilliseconds > 4.0f)
+	{
+		spdlog::warn("Pathfinding took {:.2f} ms this frame, the last searches :", fPathfindingMilliseconds);
+		for (auto& strRecord : mAStarSystem->GetPathfinder().GetStatsLog(8))
+			spdlog::warn(strRecord);
+	}
+	if (mPathfollowingSystem->Update(mRegistry, mAStarSystem->GetPathfinder(), fDeltaTime))
 	{
 		//load the next level
 		auto view = mRegistry->view<TransformComponent>();
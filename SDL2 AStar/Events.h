@@ -1,6 +1,7 @@
 #pragma once
 #include <glm.hpp>
 #include <entt/entt.hpp>
+#include "SearchContext.h"
 
 //setting a target position for player entity when the mouse clicks on a tile
 //then through astar algo the player goes
@@ -13,7 +14,34 @@ public:
 	glm::ivec2 ivStartPos;
 	//target position for the entity to go to
 	glm::ivec2 ivTargetPos;
+	//only for hierarchical searches, refine the path a few segments at a time while the entity walks it
+	bool bRefineLazily;
+	//only for time sliced searches, the pending searches with the highest priority share the budget of a frame first
+	int iPriority;
 
-	TargetPositionEvent(entt::entity entity, glm::ivec2 ivStartPos, glm::ivec2 ivTargetPos) : 
-				entity(entity), ivStartPos(ivStartPos), ivTargetPos(ivTargetPos) {}
+	TargetPositionEvent(entt::entity entity, glm::ivec2 ivStartPos, glm::ivec2 ivTargetPos, bool bRefineLazily = false, int iPriority = 0) : 
+				entity(entity), ivStartPos(ivStartPos), ivTargetPos(ivTargetPos), bRefineLazily(bRefineLazily), iPriority(iPriority) {}
 };
+
+
+//a finished search handed back to the main thread, emitted by AStarPathfindingSystem::Update for every path
+//the Pathfinder found and received by AStarPathfindingSystem itself which gives the path to the entity
+struct PathResultEvent
+{
+public:
+	entt::entity entity;
+	PathResult result;
+
+	PathResultEvent(entt::entity entity, PathResult&& result) : entity(entity), result(std::move(result)) {}
+};
+
+
+//a tile toggled between wall and floor while the level runs, emitted by MouseInputSystem on a right click
+//subscribed by AStarPathfindingSystem which edits the level and replans the entities whose paths ran over the tile
+struct TileEditEvent
+{
+public:
+	glm::ivec2 ivGridPos;
+
+	TileEditEvent(glm::ivec2 ivGridPos) : ivGridPos(ivGridPos) {}
+};
\ No newline at end of file
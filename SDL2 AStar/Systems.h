@@ -1,232 +1,499 @@
 #pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 #include <entt/entt.hpp>
 #include <spdlog/spdlog.h>
 #include "AssetStore.h"
 #include "Components.h"
 #include "WorldGrid.h"
 #include "Events.h"
+#include "Pathfinder.h"
+#include "PathCache.h"
 
 
 //creates a path using the a* algo loads it in the Pathfinding component
+//the searches themselves are done by the Pathfinder, this system turns TargetPositionEvents into its queries,
+//hands the results to the entities as PathResultEvents during Update and paints the tiles they visited
 class AStarPathfindingSystem
 {
-	struct EntityPath
+	Pathfinder mPathfinder;
+	//results taken from the Pathfinder, kept around so its capacity is reused every frame
+	std::vector<PathResult> vecResults;
+	//finished searches and cache hits waiting to be handed to their entities in Update
+	std::vector<PathResultEvent> vecPathResults;
+	//tile entity on every cell, entt::null where the level has no tile, built once the level is loaded
+	std::vector<entt::entity> vecTileEntities;
+	//cells the last displayed result painted, the only ones the next result has to revert
+	std::vector<std::int32_t> vecPaintedCells;
+	//targets are followed on flow fields instead of searched for, entities with the same target share one field
+	bool bFlowFields = false;
+	//flow field targets waiting to be handed to their entities in Update
+	std::vector<TargetPositionEvent> vecFlowTargets;
+	//the goal whose field every following entity holds, so the pathfinder keeps it while it is followed
+	std::unordered_map<std::uint32_t, glm::ivec2> mapHeldFields;
+	//paths found on this level, repeated queries and queries along a path found before are answered from it
+	PathCache mPathCache;
+	std::vector<PathfindingNode> vecCachedPath;
+	//the query of the newest search of every entity, its result goes into the cache once it is in
+	struct PendingQuery
 	{
-		entt::entity entity;
-		std::set<PathfindingNode> ClosedList;
-		std::set<PathfindingNode> OpenList;
-		PathfindingNode startNode, targetNode;
-		EntityPath(entt::entity entity, std::set<PathfindingNode> ClosedList, std::set<PathfindingNode> OpenList, PathfindingNode startNode, PathfindingNode targetNode) :
-			entity(entity), ClosedList(ClosedList), OpenList(OpenList), startNode(startNode), targetNode(targetNode) {}
+		std::uint32_t iRequestID, iGeneration;
+		glm::ivec2 ivStartPos, ivTargetPos;
+		bool bShortest;
 	};
-
-	std::vector<EntityPath> vecEntityPath;
-	std::set<PathfindingNode> OpenList;
-	std::set<PathfindingNode> ClosedList;
-	//all valid path nodes are stored here
-	std::set<PathfindingNode> AllPathNodes;
+	std::unordered_map<std::uint32_t, PendingQuery> mapPendingQueries;
+	//the newest query of every entity that searches, a path cut by an edit is searched again with it from where the entity is
+	std::unordered_map<std::uint32_t, TargetPositionEvent> mapLastQueries;
+	//entities that were given a D* Lite plan, it is dropped once they are gone or got where they were going
+	std::unordered_set<std::uint32_t> setPlannedAgents;
+	//tiles toggled since the last frame, the level is edited at the start of Update
+	std::vector<glm::ivec2> vecTileEdits;
+	//entities whose new path runs into a tile that was edited while it was searched for
+	std::vector<entt::entity> vecStaleEntities;
+	//targets are planned together with WHCA* a tick at a time so entities dont walk through each other, every tick an
+	//entity gets the one cell it is on at the next tick as its path
+	bool bCooperative = false;
+	float fTickSeconds = 0.25f, fTickTime = 0.0f, fCooperativeLogTime = 0.0f;
+	//cooperative targets waiting to be handed to the planner in Update
+	std::vector<TargetPositionEvent> vecCooperativeTargets;
+	//the cell every cooperative entity was last sent to
+	std::unordered_map<std::uint32_t, glm::ivec2> mapCooperativeCells;
 
 public:
-	AStarPathfindingSystem() {}
-
-	void InsertNode(glm::ivec2 ivGridPos)
+	Pathfinder& GetPathfinder() { return mPathfinder; }
+	const PathCache& GetPathCache() const { return mPathCache; }
+	void SetFlowFields(bool bFlowFields) { this->bFlowFields = bFlowFields; }
+	bool GetFlowFields() const { return bFlowFields; }
+	//fTickSeconds is how long a tick of the planner lasts, long enough for an entity to walk the diagonal of a tile
+	//the agents are dropped when it is turned off and the entities walk the cell they were sent to
+	void SetCooperative(bool bCooperative, float fTickSeconds)
 	{
-		AllPathNodes.insert(PathfindingNode(ivGridPos));
+		this->bCooperative = bCooperative;
+		this->fTickSeconds = fTickSeconds;
+		fTickTime = 0.0f;
+		if (!bCooperative)
+		{
+			mPathfinder.GetCooperativePlanner().Clear();
+			vecCooperativeTargets.clear();
+			mapCooperativeCells.clear();
+		}
 	}
+	bool GetCooperative() const { return bCooperative; }
 
 	void ProcessPathNodes(const TargetPositionEvent& targetPositionEvent)
 	{
-		//now init the start node
-		PathfindingNode startNode = PathfindingNode(targetPositionEvent.ivStartPos, 0.0f);
-		PathfindingNode targetNode = PathfindingNode(targetPositionEvent.ivTargetPos, 0.0f);
-		startNode.H = Heuristic(startNode.ivGridPos, targetNode.ivGridPos);
-		startNode.F = startNode.H;
-
-		//a vector is useful here instead of set since there will be modifications to the values
-		std::vector<PathfindingNode> NeighborNodes;
-		NeighborNodes.resize(8);								//8 neighbors
-
-		//add the starting node to the openlist
-		OpenList.insert(startNode);
-
-		//start the loop for traversal
-		//if the openlist gets empty that means automatically the path is invalid and is not traveresed in ConstructPath
-		PathfindingNode currentNode;
-		while (OpenList.size())
+		if (bCooperative)
 		{
-			currentNode = *OpenList.begin();
-			//get the node with the least F from the openlist
-			for (std::set<PathfindingNode>::iterator it = OpenList.begin(); it != OpenList.end(); it++)
+			vecCooperativeTargets.push_back(targetPositionEvent);
+			return;
+		}
+		if (bFlowFields)
+		{
+			vecFlowTargets.push_back(targetPositionEvent);
+			return;
+		}
+		std::uint32_t iAgent = static_cast<std::uint32_t>(targetPositionEvent.entity);
+		std::uint32_t iGeneration = mPathfinder.GetLevelGeneration();
+		mapLastQueries.insert_or_assign(iAgent, targetPositionEvent);
+		//only a hit takes a request id, a miss gets its one from Submit
+		vecCachedPath.clear();
+		float fCost = 0.0f;
+		if (mPathCache.Find(mPathfinder.GetGrid(), iGeneration, targetPositionEvent.ivStartPos, targetPositionEvent.ivTargetPos, vecCachedPath, fCost))
+		{
+			PathResult result;
+			mPathfinder.Supersede(iAgent, result);
+			//the spare buffer of the result is what the next lookup appends to
+			std::swap(result.vecPath, vecCachedPath);
+			result.fCost = fCost;
+			//handed out in Update like any other result
+			mapPendingQueries.erase(iAgent);
+			vecPathResults.emplace_back(targetPositionEvent.entity, std::move(result));
+			return;
+		}
+
+		std::uint32_t iRequestID = mPathfinder.Submit(PathQuery{ iAgent, targetPositionEvent.ivStartPos, targetPositionEvent.ivTargetPos,
+			targetPositionEvent.bRefineLazily, targetPositionEvent.iPriority });
+		//HPA* paths and those of an overestimating heuristic are only reused whole
+		bool bShortest = mPathfinder.GetSearchMode() != SEARCH_HPA && mPathfinder.GetLevelSearchPolicy().Admissible();
+		mapPendingQueries[iAgent] = PendingQuery{ iRequestID, iGeneration, targetPositionEvent.ivStartPos, targetPositionEvent.ivTargetPos, bShortest };
+		if (mPathfinder.GetSearchMode() == SEARCH_DSTAR_LITE)
+			setPlannedAgents.insert(iAgent);
+	}
+
+	//sink of TileEditEvent, keeps the tile until Update edits the level
+	void ProcessTileEdit(const TileEditEvent& tileEditEvent)
+	{
+		vecTileEdits.push_back(tileEditEvent.ivGridPos);
+	}
+
+	//sink of PathResultEvent, keeps the result until Update hands it to the entity
+	void ReceivePathResult(PathResultEvent& pathResultEvent)
+	{
+		vecPathResults.push_back(std::move(pathResultEvent));
+	}
+
+	void Update(std::unique_ptr<entt::registry>& mRegistry, std::unique_ptr<entt::dispatcher>& mDispatcher, std::unique_ptr<AssetStore>& mAssetStore, float fDeltaTime)
+	{
+		//edited before the results are taken, searches still running finish on the old level and are checked below
+		for (auto& ivGridPos : vecTileEdits)
+			EditTile(mRegistry, mAssetStore, ivGridPos);
+		vecTileEdits.clear();
+
+		//paths found since the last frame are delivered here on the main thread
+		mPathfinder.Update(vecResults);
+		for (auto& result : vecResults)
+			CachePath(result);
+		for (auto& result : vecResults)
+			mDispatcher->enqueue<PathResultEvent>(static_cast<entt::entity>(result.iAgent), std::move(result));
+		vecResults.clear();
+		mDispatcher->update<PathResultEvent>();
+
+		if (!vecPathResults.empty())
+		{
+			for (auto& pathResult : vecPathResults)
 			{
-				if (it->F <= currentNode.F)
-					currentNode = (*it);
+				//the entity could have been destroyed while its path was searched
+				if (!mRegistry->valid(pathResult.entity) || !mRegistry->all_of<PathfindingComponent>(pathResult.entity))
+					continue;
+
+				//hand the path over to the entity
+				auto& pathfinding = mRegistry->get<PathfindingComponent>(pathResult.entity);
+				//swapped so the old buffers of the component go back with the result and are reused by later searches
+				std::swap(pathfinding.vecPath, pathResult.result.vecPath);
+				std::swap(pathfinding.vecWaypoints, pathResult.result.vecWaypoints);
+				pathfinding.bFollowFlowField = false;
+				mPathfinder.RefinePath(pathfinding.vecPath, pathfinding.vecWaypoints);
+				//searched before a tile on it became a wall, it is walked up to there and searched again
+				if (BlockedStep(WorldGrid::GetGridPos(mRegistry->get<TransformComponent>(pathResult.entity).vPosition), pathfinding.vecPath) != -1)
+					vecStaleEntities.push_back(pathResult.entity);
+				//only allow all this if an actual path is found and the start node is simply not the target node
+				if (!pathfinding.vecPath.empty())
+				{
+					//set the first target for the entity to follow
+					pathfinding.bSetTargetNode = true;
+					//and dont forget to set this true so that the entity can follow
+					pathfinding.bFollowPath = true;
+				}
+
+				//display path on screen with different tiles sprites
+				if (mPathfinder.GetVisualization())
+					DisplayResult(mRegistry, mAssetStore, pathResult.result, pathfinding);
+				mPathfinder.Recycle(pathResult.result);
 			}
+			vecPathResults.clear();
+		}
+		//after the loop since a replan answered from the cache adds to vecPathResults
+		for (entt::entity entity : vecStaleEntities)
+		{
+			auto [transform, pathfinding] = mRegistry->get<TransformComponent, PathfindingComponent>(entity);
+			int iBlocked = BlockedStep(WorldGrid::GetGridPos(transform.vPosition), pathfinding.vecPath);
+			if (iBlocked != -1)
+				Replan(entity, transform, pathfinding, iBlocked);
+		}
+		vecStaleEntities.clear();
 
-			//or if we have finally reached our goal
-			if (currentNode == targetNode)			
+		for (auto& flowTarget : vecFlowTargets)
+		{
+			if (!mRegistry->valid(flowTarget.entity) || !mRegistry->all_of<PathfindingComponent>(flowTarget.entity))
+				continue;
+			//only the first entity heading for the target builds its field, the rest find it in the cache
+			const GoalDistanceField* pField = mPathfinder.HoldGoalDistanceField(flowTarget.ivTargetPos);
+			if (!pField)
+				continue;
+			if (!pField->Reaches(flowTarget.ivStartPos))
 			{
-				vecEntityPath.push_back(EntityPath(targetPositionEvent.entity, ClosedList, OpenList, startNode, currentNode));
-				break;
-			};
+				mPathfinder.ReleaseGoalDistanceField(flowTarget.ivTargetPos);
+				continue;
+			}
+			ReleaseFlowField(static_cast<std::uint32_t>(flowTarget.entity));
+			mapHeldFields[static_cast<std::uint32_t>(flowTarget.entity)] = flowTarget.ivTargetPos;
+			auto& pathfinding = mRegistry->get<PathfindingComponent>(flowTarget.entity);
+			pathfinding.vecPath.clear();
+			pathfinding.vecWaypoints.clear();
+			pathfinding.ivFlowGoal = flowTarget.ivTargetPos;
+			pathfinding.bFollowFlowField = true;
+			if (flowTarget.ivStartPos != flowTarget.ivTargetPos)
+			{
+				pathfinding.bSetTargetNode = true;
+				pathfinding.bFollowPath = true;
+			}
+		}
+		vecFlowTargets.clear();
 
-			//remove it from the openlist and put in closedlist
-			ClosedList.insert(currentNode);
-			OpenList.erase(currentNode);
+		if (bCooperative)
+			UpdateCooperative(mRegistry, fDeltaTime);
 
-			//now get the valid neighbors
-			Neighbors(currentNode, NeighborNodes);
-			for (auto neighborNode : NeighborNodes)
+		//entities that are gone, got a path or reached their goal let go of the field they followed
+		for (auto it = mapHeldFields.begin(); it != mapHeldFields.end();)
+		{
+			entt::entity entity = static_cast<entt::entity>(it->first);
+			if (mRegistry->valid(entity) && mRegistry->all_of<PathfindingComponent>(entity))
 			{
-				//first check if the neighbor is not in closed list
-				if (ClosedList.find(neighborNode) == ClosedList.end())
+				const auto& pathfinding = mRegistry->get<PathfindingComponent>(entity);
+				if (pathfinding.bFollowFlowField && pathfinding.bFollowPath && pathfinding.ivFlowGoal == it->second)
 				{
-					//if it isnt then calculate its F
-					neighborNode.H = Heuristic(neighborNode.ivGridPos, targetNode.ivGridPos);
-					neighborNode.F = neighborNode.G + neighborNode.H;
-					//now check if it isnt in OpenList
-					if (OpenList.find(neighborNode) == OpenList.end())
-					{
-						//add it if it isnt
-						OpenList.insert(neighborNode);
-					}
-					else
-					{
-						auto openNode = OpenList.extract(neighborNode);
-						if (neighborNode.G < openNode.value().G)
-						{
-							openNode.value().G = openNode.value().G;
-							openNode.value().ivParentPos = neighborNode.ivParentPos;
-						}
-						OpenList.insert(std::move(openNode));
-
-					}
+					++it;
+					continue;
 				}
 			}
+			mPathfinder.ReleaseGoalDistanceField(it->second);
+			it = mapHeldFields.erase(it);
+		}
+		//the same for the D* Lite plans, once nothing is walked or searched for anymore the plan isnt repaired again
+		for (auto it = setPlannedAgents.begin(); it != setPlannedAgents.end();)
+		{
+			entt::entity entity = static_cast<entt::entity>(*it);
+			if (mRegistry->valid(entity) && mRegistry->all_of<PathfindingComponent>(entity)
+				&& (mRegistry->get<PathfindingComponent>(entity).bFollowPath || mapPendingQueries.count(*it)))
+			{
+				++it;
+				continue;
+			}
+			mPathfinder.DropPlanner(*it);
+			it = setPlannedAgents.erase(it);
+		}
+
+		//keep lazily refined paths ahead of the entities walking them
+		for (auto [entity, pathfinding] : mRegistry->view<PathfindingComponent>().each())
+			mPathfinder.RefinePath(pathfinding.vecPath, pathfinding.vecWaypoints);
+	}
 
+	//hands the new targets to the planner and once a tick has passed moves every agent on and sends its entity to the
+	//cell it is on now, at most one tick a frame so a slow frame doesnt plan several ticks at once
+	void UpdateCooperative(std::unique_ptr<entt::registry>& mRegistry, float fDeltaTime)
+	{
+		const PathfindingGrid& grid = mPathfinder.GetGrid();
+		CooperativePlanner& planner = mPathfinder.GetCooperativePlanner();
+		for (auto& cooperativeTarget : vecCooperativeTargets)
+		{
+			if (!mRegistry->valid(cooperativeTarget.entity) || !mRegistry->all_of<PathfindingComponent>(cooperativeTarget.entity)
+				|| !grid.InBounds(cooperativeTarget.ivTargetPos.x, cooperativeTarget.ivTargetPos.y) || !grid.IsWalkable(cooperativeTarget.ivTargetPos))
+				continue;
+			std::uint32_t iAgent = static_cast<std::uint32_t>(cooperativeTarget.entity);
+			//a goal in another region would only get a field built for nothing before the planner drops it
+			glm::ivec2 ivFromPos = planner.HasAgent(iAgent) ? planner.Position(grid, iAgent) : cooperativeTarget.ivStartPos;
+			if (!mPathfinder.Connected(ivFromPos, cooperativeTarget.ivTargetPos))
+				continue;
+			if (!planner.HasAgent(iAgent))
+			{
+				planner.AddAgent(grid, iAgent, cooperativeTarget.ivStartPos);
+				mapCooperativeCells[iAgent] = cooperativeTarget.ivStartPos;
+			}
+			planner.SetGoal(iAgent, cooperativeTarget.ivTargetPos);
+		}
+		vecCooperativeTargets.clear();
+
+		fTickTime += fDeltaTime;
+		if (fTickTime < fTickSeconds)
+			return;
+		fTickTime = glm::min(fTickTime - fTickSeconds, fTickSeconds);
+		mPathfinder.StepCooperativeAgents();
+		for (auto [entity, pathfinding] : mRegistry->view<PathfindingComponent>().each())
+		{
+			std::uint32_t iAgent = static_cast<std::uint32_t>(entity);
+			auto it = mapCooperativeCells.find(iAgent);
+			if (it == mapCooperativeCells.end())
+				continue;
+			glm::ivec2 ivGridPos = planner.Position(grid, iAgent);
+			if (ivGridPos == it->second)
+				continue;
+			it->second = ivGridPos;
+			pathfinding.vecPath.assign(1, PathfindingNode(ivGridPos));
+			pathfinding.vecWaypoints.clear();
+			pathfinding.bFollowFlowField = false;
+			pathfinding.bSetTargetNode = true;
+			pathfinding.bFollowPath = true;
 		}
 
-		OpenList.clear();
-		ClosedList.clear();
+		fCooperativeLogTime += fTickSeconds;
+		if (fCooperativeLogTime < 1.0f)
+			return;
+		const CooperativePlanner::Counters& counters = planner.GetCounters();
+		if (counters.iPlans)
+			spdlog::info("Cooperative : {} agents, {:.1f} replans/s, {} deferred, {:.3f} ms per tick", planner.Count(), counters.iPlans / fCooperativeLogTime,
+				counters.iDeferred, counters.fMicroseconds / 1000.0 / glm::max<std::size_t>(counters.iTicks, 1));
+		planner.ResetCounters();
+		fCooperativeLogTime = 0.0f;
+	}
 
+	void ReleaseFlowField(std::uint32_t iAgent)
+	{
+		auto it = mapHeldFields.find(iAgent);
+		if (it == mapHeldFields.end())
+			return;
+		mPathfinder.ReleaseGoalDistanceField(it->second);
+		mapHeldFields.erase(it);
 	}
 
-	float Heuristic(const glm::ivec2& ivCurrentPos, const glm::ivec2& ivTargetPos)
+	//keeps a path that was searched for, lazily refined paths arent whole yet and paths from before the level changed are
+	//out of date
+	void CachePath(const PathResult& result)
 	{
-		float absX = static_cast<float>(glm::abs(ivCurrentPos.x - ivTargetPos.x));
-		float absY = static_cast<float>(glm::abs(ivCurrentPos.y - ivTargetPos.y));
-		float D = 1.0f, D2 = 1.414f;
-		return D * (absX + absY) + (D2 - 2.0f * D) * glm::min(absX, absY);
+		auto it = mapPendingQueries.find(result.iAgent);
+		if (it == mapPendingQueries.end() || it->second.iRequestID != result.iRequestID)
+			return;
+		const PendingQuery& query = it->second;
+		if (query.iGeneration == mPathfinder.GetLevelGeneration() && result.vecWaypoints.empty())
+			mPathCache.Insert(mPathfinder.GetGrid(), query.iGeneration, query.ivStartPos, query.ivTargetPos, result.vecPath, query.bShortest);
+		mapPendingQueries.erase(it);
 	}
 
-	void Neighbors(PathfindingNode currentNode, std::vector<PathfindingNode>& NeighborNodes)
+	//toggles the tile between wall and floor and replans only the entities whose paths are cut by the new wall
+	//a tile that opens cuts no path, the paths already found stay walkable and are kept, the next searches use it
+	//the pathfinder only updates the level data around the tile and builds the rest again off the frame, here every
+	//path that is followed is checked against the tile and every one it cuts is searched again
+	void EditTile(std::unique_ptr<entt::registry>& mRegistry, std::unique_ptr<AssetStore>& mAssetStore, const glm::ivec2& ivGridPos)
 	{
-		NeighborNodes.clear();
-		glm::ivec2 ivGridPos = currentNode.ivGridPos;
-		float G_Ortho = currentNode.G + 1.0f, G_Diag = currentNode.G + 1.414f;
-
-		//first 4 are top left right bottom and rest are diagonal ones
-		std::vector<PathfindingNode> vecNeighbors;
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x, ivGridPos.y - 1), G_Ortho));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x, ivGridPos.y + 1), G_Ortho));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x + 1, ivGridPos.y), G_Ortho));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x - 1, ivGridPos.y), G_Ortho));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x - 1, ivGridPos.y - 1), G_Diag));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x + 1, ivGridPos.y - 1), G_Diag));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x - 1, ivGridPos.y + 1), G_Diag));
-		vecNeighbors.push_back(PathfindingNode(glm::ivec2(ivGridPos.x + 1, ivGridPos.y + 1), G_Diag));
-
-		for (auto it = vecNeighbors.begin(); it != vecNeighbors.end(); it++)
-		{
-			//check if the node is a path or obstacle and is a valid neighbor to the current Node
-			//if it doesnt exist then it automatically is an obstacle and isnt added to the NeighborNodes vector
-			if (AllPathNodes.find(*it) != AllPathNodes.end())
+		const PathfindingGrid& grid = mPathfinder.GetGrid();
+		if (!grid.InBounds(ivGridPos.x, ivGridPos.y) || vecTileEntities.size() != static_cast<std::size_t>(grid.Size()))
+			return;
+		//blank space stays blank and the stairs stay the stairs
+		entt::entity entityTile = vecTileEntities[grid.Index(ivGridPos)];
+		if (entityTile == entt::null || !mRegistry->valid(entityTile))
+			return;
+		auto [sprite, tile] = mRegistry->get<SpriteComponent, TileComponent>(entityTile);
+		if (tile.mTileType == FINISH)
+			return;
+		bool bWall = tile.mTileType != WALL;
+
+		auto view = mRegistry->view<TransformComponent, PathfindingComponent>();
+		//no wall on an entity or on the tile it is walking onto
+		if (bWall)
+			for (auto [entity, transform, pathfinding] : view.each())
+				if (WorldGrid::GetGridPos(transform.vPosition) == ivGridPos || (pathfinding.bFollowPath && WorldGrid::GetGridPos(glm::vec2(pathfinding.vTargetNodePosition)) == ivGridPos))
+					return;
+
+		//the pathfinder keeps its own data consistent and moves to a new level generation so the cache isnt hit anymore
+		mPathfinder.SetWalkable(ivGridPos, !bWall);
+		tile.mTileType = bWall ? WALL : PATH;
+		sprite.texSprite = mAssetStore->GetTexture(bWall ? "sprite-wall" : "sprite-tile");
+
+		int iReplans = 0;
+		if (bWall)
+			for (auto [entity, transform, pathfinding] : view.each())
 			{
-				it->ivParentPos = currentNode.ivGridPos;
-				NeighborNodes.push_back(*it);
+				//held flow fields are stale until the pathfinder has built them again, their followers wait for it, the
+				//cooperative planner replans its own
+				if (!pathfinding.bFollowPath || pathfinding.bFollowFlowField || mapCooperativeCells.count(static_cast<std::uint32_t>(entity)))
+					continue;
+				int iBlocked = BlockedStep(WorldGrid::GetGridPos(transform.vPosition), pathfinding.vecPath);
+				if (iBlocked == -1)
+					continue;
+				Replan(entity, transform, pathfinding, iBlocked);
+				iReplans++;
 			}
-		}
+		spdlog::info("Tile ({}, {}) : {}, {} paths replanned", ivGridPos.x, ivGridPos.y, bWall ? "wall" : "floor", iReplans);
 	}
 
-
-	void Update(std::unique_ptr<entt::registry>& mRegistry, std::unique_ptr<AssetStore>& mAssetStore)
+	//the position in vecPath of the first step onto an obstacle or around a corner the level doesnt let entities cut,
+	//walking from ivGridPos, -1 if the whole path is clear
+	int BlockedStep(const glm::ivec2& ivGridPos, const std::vector<PathfindingNode>& vecPath) const
 	{
-		if (!vecEntityPath.empty())
+		const PathfindingGrid& grid = mPathfinder.GetGrid();
+		bool bCornerCutting = mPathfinder.GetLevelSearchPolicy().bCornerCutting;
+		glm::ivec2 ivFromPos = ivGridPos;
+		for (int iStep = static_cast<int>(vecPath.size()) - 1; iStep >= 0; iStep--)
 		{
-			auto view = mRegistry->view<PathfindingComponent>();
-			auto viewTiles = mRegistry->view<SpriteComponent, TileComponent>();
-			for (auto entityPath : vecEntityPath)
-			{
-				//construct path
-				auto& pathfinding = view.get<PathfindingComponent>(entityPath.entity);
-				ConstructPath(pathfinding, entityPath);
+			const glm::ivec2& ivToPos = vecPath[iStep].ivGridPos;
+			if (!grid.IsWalkable(ivToPos))
+				return iStep;
+			if (!bCornerCutting && ivToPos.x != ivFromPos.x && ivToPos.y != ivFromPos.y && (!grid.IsWalkable(ivToPos.x, ivFromPos.y) || !grid.IsWalkable(ivFromPos.x, ivToPos.y)))
+				return iStep;
+			ivFromPos = ivToPos;
+		}
+		return -1;
+	}
 
-				//display path on screen with different tiles sprites
-				for (auto [entityTile, sprite, tile] : viewTiles.each())
-				{
-					if (tile.mTileType != FINISH)
-					{
-						bool bPath = false;
-						for (auto& path : pathfinding.deqPath)
-						{
-							if (tile.ivGridPos == path.ivGridPos)
-							{
-								sprite.texSprite = mAssetStore->GetTexture("sprite-closedlist");
-								tile.mTileType = PATH_CLOSEDLIST;
-								bPath = true;
-							}
-						}
-						if (!bPath)
-						{
-							if (entityPath.ClosedList.find(tile.ivGridPos) != entityPath.ClosedList.end()
-								|| entityPath.OpenList.find(tile.ivGridPos) != entityPath.OpenList.end())
-							{
-								sprite.texSprite = mAssetStore->GetTexture("sprite-openlist");
-								tile.mTileType = PATH_OPENLIST;
-							}
-							else
-								if (tile.mTileType == PATH_CLOSEDLIST || tile.mTileType == PATH_OPENLIST)
-								{
-									sprite.texSprite = mAssetStore->GetTexture("sprite-tile");
-									tile.mTileType = PATH;
-								}
-						}
-					}
+	//the entity walks its path up to the step before iBlocked while its newest query, which can be newer than the path,
+	//is searched again from where it stands, a target that became a wall itself isnt searched for, the entity stops at
+	//the end of what is left
+	void Replan(entt::entity entity, const TransformComponent& transform, PathfindingComponent& pathfinding, int iBlocked)
+	{
+		pathfinding.vecPath.erase(pathfinding.vecPath.begin(), pathfinding.vecPath.begin() + iBlocked + 1);
+		pathfinding.vecWaypoints.clear();
+		auto it = mapLastQueries.find(static_cast<std::uint32_t>(entity));
+		if (it == mapLastQueries.end() || !mPathfinder.GetGrid().IsWalkable(it->second.ivTargetPos))
+			return;
+		TargetPositionEvent query = it->second;
+		query.ivStartPos = WorldGrid::GetGridPos(transform.vPosition);
+		ProcessPathNodes(query);
+	}
 
-				}
+	//indexes the tile entities by cell, called after the Pathfinder built its grid once the level has created them
+	void BuildTileIndex(std::unique_ptr<entt::registry>& mRegistry)
+	{
+		const PathfindingGrid& grid = mPathfinder.GetGrid();
+		vecTileEntities.assign(grid.Size(), entt::null);
+		vecPaintedCells.clear();
+		for (auto [entityTile, tile] : mRegistry->view<TileComponent>().each())
+			if (grid.InBounds(tile.ivGridPos.x, tile.ivGridPos.y))
+				vecTileEntities[grid.Index(tile.ivGridPos)] = entityTile;
+	}
 
-			}
-			vecEntityPath.clear();
-		}
+	//gives the tile on the cell a new type and sprite, the finish tile always keeps its own and so does a wall that was
+	//built on a painted cell, only EditTile changes those
+	void PaintTile(std::unique_ptr<entt::registry>& mRegistry, int iCell, TileType mTileType, SDL_Texture* texSprite)
+	{
+		entt::entity entityTile = vecTileEntities[iCell];
+		if (entityTile == entt::null || !mRegistry->valid(entityTile))
+			return;
+		auto [sprite, tile] = mRegistry->get<SpriteComponent, TileComponent>(entityTile);
+		if (tile.mTileType == FINISH || tile.mTileType == WALL)
+			return;
+		sprite.texSprite = texSprite;
+		tile.mTileType = mTileType;
 	}
 
-	//construct the path for the entity finally
-	void ConstructPath(PathfindingComponent& pathfinding, EntityPath& entityPath)
+	//reverts the tiles the previous result painted and paints the visited cells and the path of this one
+	//so the cost is the number of cells the two searches touched, not the size of the map
+	void DisplayResult(std::unique_ptr<entt::registry>& mRegistry, std::unique_ptr<AssetStore>& mAssetStore, const PathResult& result, const PathfindingComponent& pathfinding)
 	{
-		//construct path using reverse traversal
-		pathfinding.deqPath.clear();
-		PathfindingNode node = entityPath.targetNode;
-		while (node != entityPath.startNode)
+		const PathfindingGrid& grid = mPathfinder.GetGrid();
+		if (vecTileEntities.size() != static_cast<std::size_t>(grid.Size()))
+			return;
+
+		SDL_Texture* texTile = mAssetStore->GetTexture("sprite-tile");
+		for (int iCell : vecPaintedCells)
+			PaintTile(mRegistry, iCell, PATH, texTile);
+		vecPaintedCells.clear();
+
+		SDL_Texture* texOpenList = mAssetStore->GetTexture("sprite-openlist");
+		for (int iCell : result.vecVisitedCells)
 		{
-			pathfinding.deqPath.push_back(node);
-			//the nodes with their parents are in the ClosedList
-			node = *entityPath.ClosedList.find(node.ivParentPos);
+			PaintTile(mRegistry, iCell, PATH_OPENLIST, texOpenList);
+			vecPaintedCells.push_back(iCell);
 		}
-
-		//only allow all this if an actual path is found and the start node is simply not the target node
-		if (!pathfinding.deqPath.empty())
+		SDL_Texture* texClosedList = mAssetStore->GetTexture("sprite-closedlist");
+		for (auto& path : pathfinding.vecPath)
 		{
-			//set the first target for the entity to follow
-			pathfinding.bSetTargetNode = true;
-			//and dont forget to set this true so that the entity can follow
-			pathfinding.bFollowPath = true;
+			int iCell = grid.Index(path.ivGridPos);
+			PaintTile(mRegistry, iCell, PATH_CLOSEDLIST, texClosedList);
+			vecPaintedCells.push_back(iCell);
 		}
 	}
 
-
-
 	void Clear()
 	{
-		AllPathNodes.clear();
+		const PathCache::Counters& counters = mPathCache.GetCounters();
+		spdlog::info("Path cache : {} hits, {} sub path hits, {} misses", counters.iHits, counters.iSubPathHits, counters.iMisses);
+		mPathfinder.Clear();
+		//the generation changed with the level so nothing in the cache could be hit anymore, it is dropped for the memory
+		mPathCache.Clear();
+		mPathCache.ResetCounters();
+		mapPendingQueries.clear();
+		vecPathResults.clear();
+		mapLastQueries.clear();
+		vecTileEdits.clear();
+		vecStaleEntities.clear();
+		vecCooperativeTargets.clear();
+		mapCooperativeCells.clear();
+		fTickTime = 0.0f;
+		//the fields and plans went with the level
+		mapHeldFields.clear();
+		setPlannedAgents.clear();
+		vecTileEntities.clear();
+		vecPaintedCells.clear();
 	}
 };
 
@@ -241,18 +508,22 @@ class PathFollowingSystem
 public:
 
 	//tells Core whether to load the next level if the player reaches the stairs
-	bool Update(std::unique_ptr<entt::registry>& mRegistry, float& fDeltaTime)
+	//entities in flow field mode read their next node off the field of their target in the pathfinder
+	bool Update(std::unique_ptr<entt::registry>& mRegistry, Pathfinder& pathfinder, float& fDeltaTime)
 	{
 		auto view = mRegistry->view<TransformComponent, RigidBodyComponent, PathfindingComponent>();
 		for (auto [entity, transform, rigid, pathfinding] : view.each())
 		{
 			if (pathfinding.bFollowPath)
 			{
+				//the first target waits for a stale field the same way as the next ones
+				if (pathfinding.bSetTargetNode && WaitsForField(pathfinding, pathfinder))
+					rigid.bMove = false;
 				//have to call this to set the very first target
-				if (pathfinding.bSetTargetNode)
+				else if (pathfinding.bSetTargetNode)
 				{
-					SetEntityDirection(transform, pathfinding);
-					rigid.bMove = true;
+					pathfinding.bFollowPath = SetEntityDirection(transform, pathfinding, pathfinder);
+					rigid.bMove = pathfinding.bFollowPath;
 					pathfinding.bSetTargetNode = false;
 				}
 				else
@@ -263,8 +534,11 @@ public:
 					{
 						//first set the entity at that exact location of the node 
 						transform.vPosition = pathfinding.vTargetNodePosition;
-						//if the queue is empty then stop movement since the player has reached their target
-						if (pathfinding.deqPath.empty())
+						//the distance stays used up so the entity tries again next frame
+						if (WaitsForField(pathfinding, pathfinder))
+							rigid.bMove = false;
+						//set the direction for the next node, if there is none the player has reached their target
+						else if (!SetEntityDirection(transform, pathfinding, pathfinder))
 						{
 							pathfinding.bFollowPath = false;
 							rigid.bMove = false;				//stop the movement the target has been reached or not set
@@ -273,10 +547,7 @@ public:
 								return true;
 						}
 						else
-						{
-							//set the direction for the next node
-							SetEntityDirection(transform, pathfinding);
-						}
+							rigid.bMove = true;
 					}
 				}
 			}
@@ -288,17 +559,44 @@ public:
 		return false;
 	}
 
-	void SetEntityDirection(TransformComponent& transform, PathfindingComponent& pathfinding)
+	//false if there is no next node
+	//a field that is being built again after the level changed can step into the new wall, its followers stand on the
+	//cell they reached until the new one is in
+	bool WaitsForField(const PathfindingComponent& pathfinding, const Pathfinder& pathfinder) const
+	{
+		if (!pathfinding.bFollowFlowField)
+			return false;
+		const GoalDistanceField* pField = pathfinder.FindGoalDistanceField(pathfinding.ivFlowGoal);
+		return pField && pField->Stale();
+	}
+
+	bool SetEntityDirection(TransformComponent& transform, PathfindingComponent& pathfinding, Pathfinder& pathfinder)
 	{
-		//then set the next node as its target by popping it from the queue
-		currentNode = pathfinding.deqPath.back();
-		glm::vec2 vGridPos = WorldGrid::GetGridPos(pathfinding.deqPath.back().ivGridPos);
+		glm::ivec2 ivNextPos;
+		if (pathfinding.bFollowFlowField)
+		{
+			//looked up every step, the AStarPathfindingSystem holds the field so it is never built here, one whose goal
+			//was walled stops the entity
+			const GoalDistanceField* pField = pathfinder.FindGoalDistanceField(pathfinding.ivFlowGoal);
+			if (!pField || !pField->Next(WorldGrid::GetGridPos(transform.vPosition), ivNextPos))
+				return false;
+		}
+		else
+		{
+			if (pathfinding.vecPath.empty())
+				return false;
+			//then set the next node as its target by popping it from the queue
+			ivNextPos = pathfinding.vecPath.back().ivGridPos;
+			pathfinding.vecPath.pop_back();
+		}
+		currentNode.ivGridPos = ivNextPos;
+		glm::vec2 vGridPos = WorldGrid::GetGridPos(ivNextPos);
 		float fDeltaY = vGridPos.y - transform.vPosition.y, fDeltaX = vGridPos.x - transform.vPosition.x;
 		//pathfinding.fTargetNodeDistance = glm::sqrt((fDeltaY * fDeltaY) + (fDeltaX * fDeltaX));
 		pathfinding.fTargetNodeDistance = glm::distance(vGridPos, transform.vPosition);						//just use glm::distance
-		pathfinding.vTargetNodePosition = WorldGrid::GetGridPos(pathfinding.deqPath.back().ivGridPos);
-		pathfinding.deqPath.pop_back();
+		pathfinding.vTargetNodePosition = vGridPos;
 		transform.dRotation = atan2(fDeltaY, fDeltaX);
+		return true;
 	}
 
 	void SetNodeNextLevel(glm::ivec2 ivGridPos)
@@ -367,30 +665,39 @@ public:
 //obviously checks if the target position is possible and the tile is not an obstacle or anything
 class MouseInputSystem
 {
-	bool bMouseLPressed;
+	bool bMouseLPressed, bMouseRPressed;
 
 public:
 	MouseInputSystem()
 	{
 		bMouseLPressed = false;
+		bMouseRPressed = false;
 	}
 
 	void ProcessInput(std::unique_ptr<entt::registry>& mRegistry, std::unique_ptr<entt::dispatcher>& mDispatcher, SDL_Event& e, SDL_Rect& rectCamera)
 	{
-		bool bEmitEvent = false;
+		bool bEmitEvent = false, bEmitEdit = false;
 		//update the location of the cursor in accordance with the grid system and mouse movements
 		int iMouseX, iMouseY;
 		SDL_GetMouseState(&iMouseX, &iMouseY);
 		switch (e.type)
 		{
 		case SDL_MOUSEBUTTONDOWN:
-			if (!bMouseLPressed)
+			if (e.button.button == SDL_BUTTON_RIGHT)
+				bMouseRPressed = true;
+			else if (!bMouseLPressed)
 				bMouseLPressed = true;
 			break;
 
 		case SDL_MOUSEBUTTONUP:
+			//the right button toggles the tile under the cursor between wall and floor
+			if (e.button.button == SDL_BUTTON_RIGHT)
+			{
+				bEmitEdit = bMouseRPressed;
+				bMouseRPressed = false;
+			}
 			//trigger the pathfinding event TargetPositionEvent
-			if (bMouseLPressed)
+			else if (bMouseLPressed)
 			{
 				bEmitEvent = true;
 				bMouseLPressed = false;
@@ -405,13 +712,16 @@ public:
 			glm::ivec2 ivGridPos = WorldGrid::GetGridPos(static_cast<float>(iMouseX + rectCamera.x), static_cast<float>(iMouseY + rectCamera.y));
 			transform.vPosition = glm::vec2(static_cast<float>(ivGridPos.x) * WorldGrid::fTileSize, static_cast<float>(ivGridPos.y) * WorldGrid::fTileSize);
 			
+			if (bEmitEdit)
+				mDispatcher->trigger<TileEditEvent>(ivGridPos);
+
 			//trigger the Astar path event 
 			if (bEmitEvent)
 			{
 				auto viewPlayer = mRegistry->view<TransformComponent, PathfindingComponent>();
 				for (auto [entityPlayer, transform, pathfinding] : viewPlayer.each())
 				{
-					mDispatcher->trigger<TargetPositionEvent>(entityPlayer, WorldGrid::GetGridPos(transform.vPosition.x, transform.vPosition.y), ivGridPos);
+					mDispatcher->trigger<TargetPositionEvent>(entityPlayer, WorldGrid::GetGridPos(transform.vPosition.x, transform.vPosition.y), ivGridPos, true);
 				}
 			}
 		}